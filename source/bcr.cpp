@@ -0,0 +1,154 @@
+/*!
+ * Implementation of the library interface, on top of the built classes.
+ *
+ * @author Lucas Bazante
+ * @file bcr.cpp
+ */
+
+#include "bcr.h"
+
+// utils
+#include "utils/common.h"
+
+// models
+#include "models/dataset.h"
+#include "models/barChart.h"
+#include "models/fileHandler.h"
+
+namespace bcr {
+
+    // the running options matching `settings`
+    static Options to_options( const Settings &settings )
+    {
+        Options op;
+        op.max_bar = settings.max_bars;
+        op.real = settings.real;
+        op.truecolor = settings.truecolor;
+        op.threads = settings.threads;
+        op.categories = settings.categories;
+        op.label_regex = settings.label_regex;
+        op.range = settings.range;
+        op.tune_options();
+
+        return op;
+    }
+
+    struct Race::Impl
+    {
+        virtual ~Impl( void ) = default;
+        virtual Status load( const string &path ) = 0;
+        virtual void prepare( void ) = 0;
+        virtual size_t size( void ) const = 0;
+        virtual void display_initial_info( std::ostream &out, unsigned int fps ) const = 0;
+        virtual void render( size_t i, Sink &sink ) = 0;
+    };
+
+    template < typename Value >
+    struct Race::ImplOf : Race::Impl
+    {
+        Options op; // running options
+        Filter filter; // lines kept
+        std::unique_ptr< Dataset< Value > > ds; // the loaded data
+        std::vector< BarChart< Value >* > frames; // the charts, by timestamp, owned by `ds`
+        bool prepared{ false }; // whether the charts loaded are ready to be drawn
+
+        ImplOf( const Options &o ) : op{ o }, filter( o )
+        { /* empty */ }
+
+        Status load( const string &path ) override
+        {
+            this->frames.clear();
+            this->prepared = false;
+            this->ds.reset( new Dataset< Value >( this->op.truecolor ) );
+
+            FileHandler handler( path, this->filter );
+
+            if ( not handler.exists() )
+                return Status::NO_FILE;
+            if ( not handler.get_header( this->ds.get() ) )
+                return Status::BAD_HEADER;
+            if ( not handler.get_data( this->ds.get(), this->op.max_bar ) )
+                return Status::BAD_DATA;
+
+            for ( auto &chart : this->ds->get_charts() )
+                this->frames.push_back( chart.second );
+
+            return Status::OK;
+        }
+
+        void prepare( void ) override
+        {
+            if ( this->prepared or not this->ds )
+                return;
+
+            this->ds->prepare_charts( this->op.threads );
+            this->prepared = true;
+        }
+
+        size_t size( void ) const override
+        {
+            return this->frames.size();
+        }
+
+        void display_initial_info( std::ostream &out, unsigned int fps ) const override
+        {
+            if ( not this->ds )
+                return;
+
+            Options shown = this->op;
+            shown.fps = fps;
+            this->ds->display_initial_info( shown, out );
+        }
+
+        void render( size_t i, Sink &sink ) override
+        {
+            prepare(); // in case it wasn't yet
+            this->ds->display_chart( this->frames.at( i ), sink, i + 1 == this->frames.size() );
+        }
+    };
+
+    Race::Race( const Settings &settings )
+    {
+        Options op = to_options( settings );
+
+        if ( op.real )
+            this->impl.reset( new ImplOf< double >( op ) );
+        else
+            this->impl.reset( new ImplOf< int64_t >( op ) );
+    }
+
+    Race::~Race( void ) = default;
+    Race::Race( Race && ) noexcept = default;
+    Race &Race::operator=( Race && ) noexcept = default;
+
+    Status Race::load( const string &path )
+    {
+        return this->impl->load( path );
+    }
+
+    void Race::prepare( void )
+    {
+        this->impl->prepare();
+    }
+
+    size_t Race::size( void ) const
+    {
+        return this->impl->size();
+    }
+
+    void Race::display_initial_info( std::ostream &out, unsigned int fps ) const
+    {
+        this->impl->display_initial_info( out, fps );
+    }
+
+    void Race::render( size_t i, Sink &sink )
+    {
+        this->impl->render( i, sink );
+    }
+
+    void Race::render_all( Sink &sink )
+    {
+        for ( size_t i = 0; i < this->size(); i++ )
+            this->render( i, sink );
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef _BCR_H_
+#define _BCR_H_
+
+/*!
+ *  Library interface of the Bar Chart Race, for programs that want to load a race and draw its frames
+ *  in-process, without the terminal. Frames are drawn through a `Sink`: text to any stream (`TextSink`),
+ *  text kept in memory (`BufferSink`) or structured data handed to a callback (`CallbackSink`).
+ *
+ *  A minimal use would be:
+ *
+ *      bcr::Race race( settings );
+ *      if ( race.load( "cities.txt" ) == bcr::Status::OK )
+ *      {
+ *          race.prepare();
+ *          bcr::CallbackSink sink( []( const bcr::FrameData &frame ) { ... } );
+ *          race.render_all( sink );
+ *      }
+ *
+ *  Everything public lives in the `bcr` namespace, and this header only depends on the standard library.
+ *
+ *  @author Lucas Bazante
+ *  @file bcr.h
+ */
+
+#include "models/sink.h"
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bcr {
+
+    // how a race is loaded and drawn
+    struct Settings
+    {
+        unsigned int max_bars{ 5 }; // bars drawn per frame, up to 15
+        bool real{ false };         // whether values are floating-point instead of integers
+        bool truecolor{ false };    // whether categories past the 15th get 24-bit colors
+        unsigned int threads{ 0 };  // threads preparing the charts; 0 means one per core
+        std::vector< std::string > categories; // categories kept, as lists separated by commas; all, if empty
+        std::string label_regex; // regex the labels kept must contain; all, if empty
+        std::string range; // timestamps kept, as "<from>..<to>"; all, if empty
+    };
+
+    // result of loading a file
+    enum class Status
+    {
+        OK,         // everything was read
+        NO_FILE,    // the file doesn't exist or can't be opened
+        BAD_HEADER, // the title, label or source is missing
+        BAD_DATA    // the charts contain corrupted information
+    };
+
+    class Race
+    {
+        private:
+            struct Impl; // the race, whatever the type of its values
+            template < typename Value >
+            struct ImplOf; // the race, with values of type `Value`
+
+            std::unique_ptr< Impl > impl;
+
+        public:
+            //! Constructor
+            /*! Constructor method.
+             *
+             *  @param settings How the race is loaded and drawn
+             *
+             *  @throw std::regex_error if the label regex is not valid
+             */
+            explicit Race( const Settings &settings = Settings() );
+
+            ~Race( void );
+            Race( Race && ) noexcept;
+            Race &operator=( Race && ) noexcept;
+
+            //! Loads a file
+            /*! This method reads the header and all the charts of a file, replacing whatever was loaded before.
+             *
+             *  @param path The path of the file
+             *
+             *  @return Whether the file was read, or why it wasn't
+             */
+            Status load( const std::string &path );
+
+            //! Prepares the charts
+            /*! This method prepares every chart loaded for drawing: sorts its bars, keeps only the greater ones and sets their widths.
+             *  The charts are prepared in parallel, with as many threads as set on the running options.
+             *  Drawing prepares them on its own if this wasn't called, so this is only needed to choose when the work is done.
+             *  Calling it again before the next `load()` does nothing.
+             */
+            void prepare( void );
+
+            //! Gets the number of frames
+            /*! @return How many frames, i.e. charts, the race has.
+             */
+            size_t size( void ) const;
+
+            //! Display initial info
+            /*! This method prints what the program shows before a race: how many charts and categories were loaded,
+             *  with the categories in their colors, the animation speed, and the title, label and source.
+             *
+             *  @param out Where the information is printed
+             *  @param fps The animation speed shown
+             */
+            void display_initial_info( std::ostream &out, unsigned int fps ) const;
+
+            //! Draws a frame
+            /*! The charts are prepared first, if they weren't yet.
+             *
+             *  @param i The frame, from 0 to `size() - 1`, in timestamp order
+             *  @param sink Where the frame is drawn
+             */
+            void render( size_t i, Sink &sink );
+
+            //! Draws all frames
+            /*! The charts are prepared first, if they weren't yet.
+             *
+             *  @param sink Where the frames are drawn, in timestamp order
+             */
+            void render_all( Sink &sink );
+    };
+}
+
+#endif
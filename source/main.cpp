@@ -14,6 +14,95 @@
 #include "models/dataset.h"
 #include "models/barChart.h"
 #include "models/fileHandler.h"
+#include "models/pipeline.h"
+#include "models/sink.h"
+
+// library
+#include "bcr.h"
+
+//! Runs the race
+/*! This function loads the data from the file through the library, and then displays each of its charts.
+ *
+ *  @param op The running options
+ *
+ *  @return The exit status of the program
+ */
+int race( const Options &op )
+{
+    bcr::Settings settings;
+    settings.max_bars = op.max_bar;
+    settings.real = op.real;
+    settings.truecolor = op.truecolor;
+    settings.threads = op.threads;
+    settings.categories = op.categories;
+    settings.label_regex = op.label_regex;
+    settings.range = op.range;
+
+    bcr::Race race( settings ); // the regex was already checked
+
+    switch ( race.load( op.filepath ) )
+    {
+        case bcr::Status::OK:
+            break;
+        case bcr::Status::NO_FILE:
+            std::cout << Color::tcolor( "\n>>> [ERROR]: you've provided an invalid filepath! Terminating excution.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
+            return EXIT_FAILURE;
+        case bcr::Status::BAD_HEADER:
+            std::cout << Color::tcolor( "\n>>> [ERROR]: your file has less information than needed! Please double check it.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
+            return EXIT_FAILURE;
+        case bcr::Status::BAD_DATA:
+            std::cout << Color::tcolor( "\n>>> [ERROR]: your file contains corrupted information! Please double check it.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
+            return EXIT_FAILURE;
+    }
+
+    race.prepare(); // sorts, purges and sets the widths of each chart, in parallel
+
+    race.display_initial_info( std::cout, op.fps );
+    std::cin.ignore(); // "press enter to continue..."
+
+    bcr::TextSink terminal( std::cout, op.fps ); // the terminal, keeping the FPS
+    race.render_all( terminal );
+
+    std::cout << Color::tcolor( "\n>>> That's it for this race! Hope you enjoyed it!\n", Color::BRIGHT_BLUE, Color::BOLD ) << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+//! Runs the race, pipelined
+/*! This function reads, prepares and displays the charts at the same time, into a dataset whose values are of type `Value`.
+ *
+ *  @param op The running options
+ *  @param handler The handler of the data file
+ *
+ *  @return The exit status of the program
+ */
+template < typename Value >
+int pipelined_race( Options op, FileHandler &handler )
+{
+    std::unique_ptr< Dataset< Value > > ds( new Dataset< Value >( op.truecolor ) ); // owns the categories read along the way
+
+    if ( not handler.get_header( ds.get() ) )
+    {
+        std::cout << Color::tcolor( "\n>>> [ERROR]: your file has less information than needed! Please double check it.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ds->display_initial_info( op, std::cout );
+    std::cin.ignore(); // "press enter to continue..."
+
+    Pipeline< Value > pipeline( handler, ds.get(), op );
+
+    if ( not pipeline.run() )
+    {
+        std::cout << Color::tcolor( "\n>>> [ERROR]: your file contains corrupted information! Please double check it.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    pipeline.display_metrics();
+    std::cout << Color::tcolor( "\n>>> That's it for this race! Hope you enjoyed it!\n", Color::BRIGHT_BLUE, Color::BOLD ) << std::endl;
+
+    return EXIT_SUCCESS;
+}
 
 int main( int argc, char *argv[] )
 {
@@ -30,62 +119,55 @@ int main( int argc, char *argv[] )
     for ( int i{ 1 }; i < argc; i++ )
     {
         if ( string(argv[i]) == "--b" )
-            op.max_bar = std::stoul( argv[i + 1] );
+            op.max_bar = std::stoul( argv[++i] );
         else if ( string(argv[i]) == "--f" )
-            op.fps = std::stoul( argv[i + 1] );
+            op.fps = std::stoul( argv[++i] );
+        else if ( string(argv[i]) == "--r" )
+            op.real = true;
+        else if ( string(argv[i]) == "--tc" )
+            op.truecolor = true;
+        else if ( string(argv[i]) == "--category" )
+            op.categories.push_back( argv[++i] );
+        else if ( string(argv[i]) == "--label-regex" )
+            op.label_regex = argv[++i];
+        else if ( string(argv[i]) == "--range" )
+            op.range = argv[++i];
+        else if ( string(argv[i]) == "--t" )
+            op.threads = std::stoul( argv[++i] );
+        else if ( string(argv[i]) == "--p" )
+            op.pipelined = true;
+        else if ( string(argv[i]) == "--qp" )
+            op.parse_depth = std::stoul( argv[++i] );
+        else if ( string(argv[i]) == "--qr" )
+            op.render_depth = std::stoul( argv[++i] );
         else
             op.filepath = string( argv[i] );
     }
 
     op.tune_options();
 
-    FileHandler handler( op.filepath );
-
-    if ( not handler.exists() )
-    {
-        std::cout << Color::tcolor( "\n>>> [ERROR]: you've provided an invalid filepath! Terminating excution.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
-        return EXIT_FAILURE;
-    }
-
-    Dataset *ds = new Dataset();
+    Filter filter;
 
-    if ( not handler.get_header( ds ) )
+    try
     {
-        std::cout << Color::tcolor( "\n>>> [ERROR]: your file has less information than needed! Please double check it.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
-        return EXIT_FAILURE;
+        filter = Filter( op );
     }
-
-    if ( not handler.get_data( ds, op.max_bar ) )
+    catch ( const std::regex_error & )
     {
-        std::cout << Color::tcolor( "\n>>> [ERROR]: your file contains corrupted information! Please double check it.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
+        std::cout << Color::tcolor( "\n>>> [ERROR]: your label regex is invalid! Terminating execution.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
         return EXIT_FAILURE;
     }
 
-    ds->display_initial_info( op );
-    std::cin.ignore(); // "press enter to continue..."
+    if ( not op.pipelined ) // the library does it all
+        return race( op );
 
-    auto charts{ ds->get_charts() }; // get the charts
-    int size = charts.size(), curr = 0;
+    FileHandler handler( op.filepath, filter );
 
-    for ( auto chart : charts )
+    if ( not handler.exists() )
     {
-        curr++;
-    
-        ds->display_header( chart.first );
-        chart.second->print_chart( ds );
-        chart.second->print_footer( ds->get_label(), ds->get_source() );
-        ds->display_categories();
-
-        if ( curr != size ) // only flushes screen if its not the last one
-            std::cout << "\033[2J\033[1;1H";
-
-        std::chrono::milliseconds duration{ 1000 / op.fps };
-        std::this_thread::sleep_for( duration );
-
-        std::cout << std::endl;
+        std::cout << Color::tcolor( "\n>>> [ERROR]: you've provided an invalid filepath! Terminating excution.\n", Color::BRIGHT_RED, Color::BOLD ) << std::endl;
+        return EXIT_FAILURE;
     }
 
-    std::cout << Color::tcolor( "\n>>> That's it for this race! Hope you enjoyed it!\n", Color::BRIGHT_BLUE, Color::BOLD ) << std::endl;
- 
-    return EXIT_SUCCESS;
+    return op.real ? pipelined_race< double >( op, handler ) : pipelined_race< int64_t >( op, handler );
 }
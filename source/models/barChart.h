@@ -4,6 +4,7 @@
 /*!
  *  This file contains a class to store a single chart.
  *  A chart contains n bars, and it is "mapped" to a single timestamp.
+ *  The bars values are of type `Value`, either int64_t or double.
  *
  *  @author Lucas Bazante
  *  @file bar_chart.h
@@ -11,24 +12,60 @@
 
 #include "../utils/common.h"
 #include "../utils/text_color.h"
+#include "../utils/widths.h"
+#include "sink.h"
 #include "dataset.h"
 
+#include <charconv>
+
+template < typename Value >
 class BarChart
 {
     private:
-        std::vector< Bar > bars; // our vector of Bar items
+        std::vector< Bar< Value > > bars; // our vector of Bar items
         string timestamp; // timestamp for the BarChart object
         unsigned int n_bars; // number of bars in the BarChart object
 
+        // writes the text of a value, as a stream would print it ("%g" for reals), into `text`, reusing its storage
+        static void format( Value value, string &text )
+        {
+            char buffer[32];
+            std::to_chars_result result;
+
+            if constexpr ( std::is_floating_point< Value >::value )
+                result = std::to_chars( buffer, buffer + sizeof( buffer ), value, std::chars_format::general, 6 );
+            else
+                result = std::to_chars( buffer, buffer + sizeof( buffer ), value );
+
+            text.assign( buffer, result.ptr );
+        }
+
+        // text of a mark on the axis; marks are kept as doubles, as the rounded up max may not fit `Value`
+        static string format_tick( double tick )
+        {
+            if constexpr ( std::is_floating_point< Value >::value )
+            {
+                string text;
+                format( tick, text );
+                return text;
+            }
+            else // marks of integers are whole numbers, so they're printed just like a `Value` would be
+            {
+                char buffer[32];
+                auto result = std::to_chars( buffer, buffer + sizeof( buffer ), tick, std::chars_format::fixed, 0 );
+                return string( buffer, result.ptr );
+            }
+        }
+
     public:
         //! Appends a bar
         /*! This method appends a Bar item to our vector `bars`.
          *
          *  @param bar The Bar item to be appended
          */
-        void push_a_bar( Bar bar )
+        void push_a_bar( Bar< Value > bar )
         {
-            this->bars.push_back( bar );
+            this->bars.push_back( std::move( bar ) );
         }
 
         //! Sets the timestamp
@@ -64,69 +101,112 @@ class BarChart
             return this->timestamp;
         }
 
-        //! Sorts the bar vector
-        /*! This method sorts our `bars` vector, returning it in a non-decreasing orderly fashion.
-         *  It does so by comparing the bar items values with the function cmp_bar, that returns
-         *  true if a given bar's value is greater than the other.
+        //! Sets the widths for all our bars
+        /*! This method set the widths for all of our bars. This is a "relative width"; it is done by
+         *  taking the maximum value from the vector, i.e. the first element since it is already sorted at this point,
+         *  and making it as "100%" of the width. The rest of the bars will have a percentage of the width based on the max value;
+         *  for example, supposing a max value of 500 and a bar with value 250, the second bar will have 250/500 = 0.5 = 50% of the full width.
          *  
-         *  We sort it non-decreasingly because we want to print the bars in the chart precisly in this order,
-         *  and by sorting we can also remove the "lesser" bars which exceed our `n_bars` limit, which is done
-         *  with `purge_bars()`.
+         *  The full width is a fixed value of 150. The ratio is taken in double precision, so even values past 32 bits
+         *  can't overflow it, and non-positive values get no width at all.
+         *
+         *  The values are gathered in small blocks on the stack and scaled with `Widths::scale()`, the same vectorized pass
+         *  `Dataset::prepare_charts()` runs over many charts at once.
          */
-        void sort_bars( void )
+        void set_widths( void )
         {
-            std::sort( this->bars.begin(), this->bars.end(), cmp_bar );
+            if ( this->bars.empty() )
+                return;
+
+            static constexpr size_t BLOCK{ 16 }; // room for the most bars a chart is raced with
+            array< double, BLOCK > values, maxes;
+            array< unsigned char, BLOCK > widths;
+
+            maxes.fill( this->bars[0].value ); // the vector is already sorted and "purged" at this point
+
+            for ( size_t first = 0; first < this->bars.size(); first += BLOCK )
+            {
+                size_t n = std::min( BLOCK, this->bars.size() - first );
+
+                for ( size_t i = 0; i < n; i++ )
+                    values[i] = this->bars[first + i].value;
+
+                Widths::scale( values.data(), maxes.data(), n, widths.data() );
+
+                for ( size_t i = 0; i < n; i++ )
+                    this->bars[first + i].width = widths[i];
+            }
         }
 
-        //! Removes unneeded bars
-        /*! This method removes all the unneeded bars from our vector. When this method is called,
-         *  we assume that the vector is already sorted, i.e. `sort_bars()` was already called.
-         *  So, assuming it is sorted, we use `std::vector.pop_back()`, which removes the last element,
-         *  until our vector size is equal to our limit `n_bars`; as we only need to use the greater `n_bars` from each chart,
-         *  we can safely remove the unneeded ones.
+        //! Keeps only the greater bars
+        /*! This method sorts the bars non-increasingly by value, comparing them with `cmp_bar()`, and removes all but the
+         *  `n_bars` greater ones, as we only print those. Only the bars kept are actually sorted.
          */
-        void purge_bars( void )
+        void select_bars( void )
         {
-            while ( this->bars.size() != this->n_bars )
-                this->bars.pop_back();
+            size_t n = std::min< size_t >( this->n_bars, this->bars.size() );
+            std::partial_sort( this->bars.begin(), this->bars.begin() + n, this->bars.end(), cmp_bar< Value > );
+            this->bars.resize( n );
         }
 
-        //! Sets the widths for all our bars
-        /*! This method set the widths for all of our bars. This is a "relative width"; it is done by
-         *  taking the maximum value from the vector, i.e. the first element since it is already sorted at this point,
-         *  and making it as "100%" of the width. The rest of the bars will have a percentage of the width based on the max value;
-         *  for example, supposing a max value of 500 and a bar with value 250, the second bar will have 250/500 = 0.5 = 50% of the full width.
-         *  
-         *  The full width is a fixed value of 150.
+        //! Gathers the values
+        /*! This method appends, for each bar, its value to `values` and the max value of the chart to `maxes`,
+         *  so the widths of many charts can be set in a single pass with `Widths::scale()`.
+         *  The bars must be already sorted, i.e. `select_bars()` was already called.
+         *
+         *  @param values The column of values
+         *  @param maxes The column of max values
          */
-        void set_widths( void )
+        void gather_values( std::vector< double > &values, std::vector< double > &maxes )
         {
-            int max = this->bars[0].value; // the vector is already sorted and "purged" at this point
-
             for ( auto &bar : this->bars )
             {
-                float percentage = ( float ) bar.value / ( float ) max;
-                bar.width = 150 * percentage;
+                values.push_back( bar.value );
+                maxes.push_back( this->bars[0].value );
             }
         }
 
+        //! Sets the widths from a column
+        /*! This method sets the widths of the bars from a column of widths, in the order of `gather_values()`.
+         *
+         *  @param widths Pointer to the width of the first bar
+         *
+         *  @return How many widths were taken
+         */
+        size_t scatter_widths( const unsigned char *widths )
+        {
+            for ( size_t i = 0; i < this->bars.size(); i++ )
+                this->bars[i].width = widths[i];
+            return this->bars.size();
+        }
+
+        //! Prepares the chart for display
+        /*! This method sorts the bars, removes the exceeding ones and sets the widths of the remaining,
+         *  leaving the chart ready to be printed.
+         */
+        void prepare( void )
+        {
+            this->select_bars();
+            this->set_widths();
+        }
 
         //! Prints the chart object
         /*! This method prints the chart object, printing the entire vector. At this point, the vector
          *  is already sorted and freed from exceeding bars, so we don't need to worry about ranges whatsoever.
          *  Each bar gets its color based on its category, making use of the pointer to Dataset object, in which the
-         *  relation "category x colors" are stored.
+         *  relation "category x colors" are stored. Colors are looked up by category id.
          *
          *  @param ds A pointer to a Dataset object, from which we'll extract the colors for the bars.
+         *  @param sink Where the bars are drawn.
          */
         template < class DatasetPointer >
-        void print_chart( DatasetPointer ds )
+        void print_chart( DatasetPointer ds, bcr::Sink &sink )
         {
-            for ( auto bar : this->bars )
+            string value; // reused by every bar
+            for ( auto &bar : this->bars )
             {
-                short color = ds->get_color( bar.category ); // getting the color for the category, or a single color if there are more than 14 categories
-                string colored = Color::tcolor( Color::multiply( Color::UNIT, bar.width ), color ); // coloring the bar
-                std::cout << colored << " " << Color::tcolor( bar.label, color ) << " [" << bar.value << "]" << std::endl << std::endl; // print label [value]
+                format( bar.value, value );
+                sink.bar( bar.label, ds->get_category( bar.category ), bar.category, ds->get_color( bar.category ), value, bar.width );
             }
         }
 
@@ -134,69 +214,97 @@ class BarChart
         /*! This method prints the footer for the chart object.
          *  The footer contains the source of the dataset, a label containing the unit the dataset is operating on (example, Population (thousands)),
          *  and a x-axis, containing five evenly spaced points on the min and max values from the chart, marked by "+" on the axis. As each BarChart is printed out,
-         *  the axis will change accordingly with the values.
+         *  the axis will change accordingly with the values. The axis is given to the sink both as text and as a list of marks.
          *
          *  @param label String text containing the label of the chart
          *  @param source String text containing the source of the chart
+         *  @param sink Where the footer is drawn
          */
-        void print_footer( string label, string source )
+        void print_footer( const string &label, const string &source, bcr::Sink &sink )
         {
             std::stringstream axis; // the "ticks" ----+---+---->
             std::stringstream points; // the values from each mark +
+            std::vector< bcr::Tick > ticks{ { "0", 0 } }; // the marks, as given to the sink
 
             // it always start on 0
             axis << "+";
             points << "0";
 
-            std::vector< int > sequence; // the values
+            std::vector< double > sequence; // the values
             std::vector< int > widths; // the value's widths
 
-            int max = ( this->bars.begin() )->value;
-            int min = ( this->bars.end() - 1 )->value;
-            
+            // the math, and the marks, are kept in double precision, so rounding up a value near the limits of `Value` can't overflow
+            double max = ( this->bars.begin() )->value;
+            double min = ( this->bars.end() - 1 )->value;
+
+            // the axis always starts on 0, so there's no room for negatives
+            if ( min < 0 )
+                min = 0;
+            if ( max < 0 )
+                max = 0;
+
             // how many digits each?
-            int dmax = std::log10( max ) + 1;
-            int dmin = std::log10( min ) + 1;
+            int dmax = ( max > 0 ) ? std::floor( std::log10( max ) ) + 1 : 1;
+            int dmin = ( min > 0 ) ? std::floor( std::log10( min ) ) + 1 : 1;
 
             // powers of ten based on digit; ex: a 4 digit number as max value would have 10^(4 - 2) as its power
-            int maxpow = ( int ) ( std::pow( 10, dmax - 2 ) + 0.5 );
-            int minpow = ( int ) ( std::pow( 10, dmin - 1 ) + 0.5 );
+            double maxpow = std::pow( 10, dmax - 2 );
+            double minpow = std::pow( 10, dmin - 1 );
+
+            if ( std::is_integral< Value >::value ) // integers can't be rounded to fractions
+            {
+                maxpow = std::max( std::round( maxpow ), 1.0 );
+                minpow = std::max( std::round( minpow ), 1.0 );
+            }
 
-            min -= ( min % minpow ); // rounds down to nearest n-digit number; i.e 361 would go to 300
-            max += ( maxpow - ( max % maxpow ) ); // rounds up to nearest multiple of maxpow (10 ^ {dmax - 2})
+            min -= std::fmod( min, minpow ); // rounds down to nearest n-digit number; i.e 361 would go to 300
+            max += ( maxpow - std::fmod( max, maxpow ) ); // rounds up to nearest multiple of maxpow (10 ^ {dmax - 2})
 
-            int step = ( max - min ) / 5; // calculate step for 5 points
+            double step = ( max - min ) / 5; // calculate step for 5 points
+            if ( std::is_integral< Value >::value )
+                step = std::trunc( step );
 
-            if ( step == 0 )
-            { 
+            if ( step > 0 )
+            {
+                // set widths for all 5 points
+                for ( int k = 0; min + k * step <= max + step * 1e-9; k++ )
+                {
+                    double i = min + k * step;
+                    unsigned char w = Widths::width( i, max );
+                    if ( w == 0 ) // lands on the 0 we already have
+                        continue;
+
+                    sequence.push_back( i ); // pusheds the value
+                    widths.push_back( w ); // pushes the width for the value
+                }
+            }
+
+            if ( widths.empty() )
+            {
                 for ( int i = 0; i <= 150; i++ )
                 {
                     if ( i == 150 )
-                        axis << "+", points << max;
+                    {
+                        axis << "+", points << format_tick( max );
+                        ticks.push_back( { format_tick( max ), 150 } );
+                    }
 
                     axis << "-", points << " ";
                 }
             }
-            else 
+            else
             {
-                // set widths for all 5 points
-                for ( int i = min; i <= max; i += step )
-                {
-                    sequence.push_back( i ); // pusheds the value
-                    float percentage = ( float ) i / ( float ) max;
-                    int width = 150 * percentage;
-                    widths.push_back( width ); // pushes the width for the value
-                }
-
                 int count =  0;
-                short lw = 0; // keep track of how many digits the last value got
+                size_t lw = 0; // keep track of how many characters the last value got
                 for ( int i = 0; i <= *( widths.end() - 1 ); i++ )
                 {
                     if ( std::find( widths.begin(), widths.end(), i ) != widths.end() )
                     {
+                        string text = format_tick( sequence.at( count ) );
                         axis << "+";
-                        points << sequence.at( count );
-                        lw = std::log10( sequence.at( count ) ); // digits - 1 from the last number, so we can skip whitespaces on points
+                        points << text;
+                        ticks.push_back( { text, i } );
+                        lw = text.size() - 1; // characters - 1 from the last number, so we can skip whitespaces on points
                         count++;
                         continue;
                     }
@@ -215,9 +323,7 @@ class BarChart
 
             axis << "----------------------------->"; // adding a final
 
-            std::cout << axis.str() << std::endl << Color::tcolor( points.str(), Color::YELLOW ) << std::endl;
-            std::cout << Color::tcolor( label, Color::YELLOW, Color::BOLD ) << std::endl << std::endl;
-            std::cout << Color::tcolor( source, Color::WHITE, Color::BOLD ) << std::endl;
+            sink.footer( axis.str(), points.str(), ticks, label, source );
         }
 };
 
@@ -2,7 +2,8 @@
 #define _DATASET_H_
 
 /*!
- *  This file contains a class to store the information about the data in the passed file
+ *  This file contains a class to store the information about the data in the passed file,
+ *  whose values are of type `Value`, either int64_t or double.
  *
  *  @author Lucas Bazante
  *  @file dataset.h
@@ -10,16 +11,26 @@
 
 #include "../utils/common.h"
 #include "../utils/text_color.h"
+#include "../utils/palette.h"
+#include "sink.h"
 #include "barChart.h"
 
+#include <atomic>
+#include <unordered_map>
+
+template < typename Value >
+class BarChart;
+
+template < typename Value >
 class Dataset
 {
     private:
-        std::map< string, BarChart* > charts; // maps a chart pointer with a timestamp
-        std::map< string, short > categories; // maps each category with a short integer reprenting its color
-        
-        bool single_colored = false; // if we have more than 14 categories, this'll be set to true
-        short color = 31; // initial color
+        std::map< string, BarChart< Value >* > charts; // maps a chart pointer with a timestamp
+        std::unordered_map< string, unsigned int > ids; // maps each category with its id, given in the order they were found
+        std::vector< string > categories; // the categories, by id
+        Palette palette; // the colors, by category id
+
+        std::vector< unsigned int > sorted; // category ids, by name, so the legend is alphabetical
 
         // header info
         string title;
@@ -27,36 +38,161 @@ class Dataset
         string source;
 
     public:
+        //! Constructor
+        /*! Constructor method.
+         *
+         *  @param truecolor Whether categories past the 15th get 24-bit colors, instead of colors from the 256-color cube
+         */
+        Dataset( bool truecolor = false ) : palette{ truecolor }
+        { /* empty */ }
+
+        //! Destructor
+        /*! Destructor method.
+         *  Frees the charts.
+         */
+        ~Dataset( void )
+        {
+            for ( auto &chart : this->charts )
+                delete chart.second;
+        }
+
+        Dataset( const Dataset & ) = delete; // the charts are owned by a single dataset
+        Dataset &operator=( const Dataset & ) = delete;
+
         //! Inserts a chart
         /*! This method inserts a pointer to a BarChart object to our map `charts`, mapping
-         *  the pointer with a timestamp, the timestamp from the chart.
+         *  the pointer with a timestamp, the timestamp from the chart. The dataset takes ownership of the chart;
+         *  if there's already a chart with the same timestamp, the new one is discarded.
+         *  The chart is stored as read, and must be prepared with `prepare_charts()` before being displayed.
          *
          *  @param chart Pointer to a chart object that'll be stored.
          */
-        void push_a_chart( BarChart *chart )
+        void push_a_chart( BarChart< Value > *chart )
         {
-            chart->sort_bars(); // sorts the received chart
-            chart->purge_bars(); // removes exceeding bars
-            chart->set_widths(); // sets the widths
-            this->charts.insert( { chart->get_timestamp(), chart } ); // inserts
+            if ( not this->charts.insert( { chart->get_timestamp(), chart } ).second ) // inserts
+                delete chart;
+        }
+
+        //! Prepares all charts
+        /*! This method prepares every chart for display, i.e. sorts each one, removes its exceeding bars and sets the widths.
+         *  The charts are split in blocks, taken by the threads as they get free. For each block, a thread first keeps only the
+         *  greater bars of each chart, then gathers the values left into a single column and sets all their widths in one
+         *  vectorized pass, with `Widths::scale()`.
+         *
+         *  @param threads How many threads to use; 0 means one per core
+         */
+        void prepare_charts( unsigned int threads = 0 )
+        {
+            static constexpr size_t BLOCK{ 256 }; // charts taken at once by a thread
+
+            std::vector< BarChart< Value >* > all;
+            all.reserve( this->charts.size() );
+            for ( auto &chart : this->charts )
+                all.push_back( chart.second );
+
+            size_t n_blocks = ( all.size() + BLOCK - 1 ) / BLOCK;
+
+            if ( threads == 0 )
+                threads = std::max( std::thread::hardware_concurrency(), 1u );
+            threads = std::min< size_t >( threads, std::max< size_t >( n_blocks, 1 ) );
+
+            std::atomic< size_t > next{ 0 }; // next block to be taken
+
+            auto work = [&]( void )
+            {
+                std::vector< double > values, maxes; // reused by every block of this thread
+                std::vector< unsigned char > widths;
+
+                for ( size_t b; ( b = next++ ) < n_blocks; )
+                {
+                    size_t first = b * BLOCK, last = std::min( first + BLOCK, all.size() );
+
+                    values.clear();
+                    maxes.clear();
+
+                    for ( size_t i = first; i < last; i++ )
+                    {
+                        all[i]->select_bars();
+                        all[i]->gather_values( values, maxes );
+                    }
+
+                    widths.resize( values.size() );
+                    Widths::scale( values.data(), maxes.data(), values.size(), widths.data() );
+
+                    const unsigned char *at = widths.data();
+                    for ( size_t i = first; i < last; i++ )
+                        at += all[i]->scatter_widths( at );
+                }
+            };
+
+            std::vector< std::thread > pool;
+            for ( unsigned int t = 1; t < threads; t++ )
+                pool.emplace_back( work );
+
+            work(); // this thread helps too
+
+            for ( auto &t : pool )
+                t.join();
         }
 
         //! Inserts a category
-        /*! This method inserts a category into our categories map, mapping it with a short integer,
-         *  which represents one of the 14 colors available. If the categories size reaches a value greater than
-         *  14, sets the bool `single_colored` to true, because we only have 14 colors, so if there's more, it'll
-         *  set all categories to a single color.
+        /*! This method inserts a category, if it isn't there yet, giving it the next id and its own color.
+         *  The ids are dense, so the color of a category is just an index into the palette, with no limit on how many there are.
          *
          *  @param category The category to be inserted
+         *
+         *  @return The category id
+         */
+        unsigned int push_a_category( const string &category )
+        {
+            auto found = this->ids.find( category );
+            if ( found != this->ids.end() )
+                return found->second;
+
+            unsigned int id = this->categories.size();
+            this->ids.emplace( category, id );
+            this->categories.push_back( category );
+            this->palette.add();
+
+            // keeps the legend order up to date
+            auto at = std::upper_bound( this->sorted.begin(), this->sorted.end(), category,
+                                        [this]( const string &name, unsigned int i ) { return name < this->categories[i]; } );
+            this->sorted.insert( at, id );
+
+            return id;
+        }
+
+        //! Gets number of categories
+        /*! This method gets how many different categories were inserted so far.
+         *
+         *  @return The number of categories.
+         */
+        size_t n_categories( void )
+        {
+            return this->categories.size();
+        }
+
+        //! Gets a category
+        /*! This method gets a category by the order it was found, so a client can
+         *  replay the categories into another dataset in the same order, getting the same colors.
+         *
+         *  @param i The position of the category, i.e. its id, from 0 to `n_categories() - 1`
+         *
+         *  @return The i-th category found.
          */
-        void push_a_category( string category )
+        const string &get_category( size_t i )
         {
-            if ( this->categories.size() > 14 )
-                this->single_colored = true;
+            return this->categories[i];
+        }
 
-            if ( this->categories.insert( { category, this->color } ).second )
-                if ( not this->single_colored ) // only increases if we have enough
-                    this->color = ( this->color + 1 == 38 ) ? 90 : this->color + 1; // sequentially define the color, past 37 the next is 90
+        //! Gets title
+        /*! This method gets the dataset's title.
+         *  
+         *  @return The dataset's title.
+         */
+        string get_title( void )
+        {
+            return this->title;
         }
 
         //! Gets label
@@ -85,7 +221,7 @@ class Dataset
          *
          *  @return The dataset's charts map.
          */
-        std::map< string, BarChart* > get_charts( void )
+        std::map< string, BarChart< Value >* > get_charts( void )
         {
             return this->charts;
         }
@@ -104,93 +240,102 @@ class Dataset
             this->source = s;
         }
 
-        //! Gets color short
-        /*! This method returns a short representing a color based on the passed category,
-         *  returning the short integer mapped to the category. If there are more than 14 categories,
-         *  i.e. `single_colored` is true, it'll return `Color::RED` no matter the category.
+        //! Gets color
+        /*! This method returns the color of the given category, as a palette code.
          *
-         *  @param category The category to get the color
+         *  @param category The category id
          *
-         *  @return The short mapped to the category or a single color for all.
+         *  @return The color of the category.
          */
-        short get_color( string category )
+        const bcr::CategoryColor &get_color( unsigned int category )
         {
-            if ( this->single_colored )
-                return Color::RED;
-            return this->categories[category];
+            return this->palette.color( category );
         }
 
         //! Display dataset information
         /*! This method prints the information about the dataset, printing its title, label, source,
-         *  how many categories, how many charts, all the categories colored by its related colors (or all in a single color if thats the case).
+         *  how many categories, how many charts, all the categories colored by its related colors.
          *  It also prints the FPS, i.e. the animation speed.
+         *  When running pipelined, the charts are read while the race goes on, so only the header info is known and printed.
          *
          *  @param op The running options, from where we'll extract the defined FPS
+         *  @param out Where the information is printed
          */
-        void display_initial_info( Options op )
+        void display_initial_info( Options op, std::ostream &out )
         {
             std::stringstream msg;
-            msg << "\n\n>>> We have " << this->charts.size() << " charts.\n\n";
+
+            if ( op.pipelined )
+                msg << "\n\n>>> Charts are read while the race runs.\n\n";
+            else
+                msg << "\n\n>>> We have " << this->charts.size() << " charts.\n\n";
 
             msg << ">>> Animation speed is " << op.fps;
             msg << "\n>>> Title: " << this->title;
             msg << "\n>>> Value: " << this->label;
             msg << "\n>>> Source: " << this->source;
+
+            if ( op.pipelined )
+            {
+                out << Color::tcolor( msg.str(), Color::GREEN, Color::BOLD ) << std::endl;
+                out << Color::tcolor( "\n>>> Press ENTER to begin the race: \n", Color::BLUE, Color::BOLD );
+                return;
+            }
             
             msg << "\n\n>>> We have " << this->categories.size() << " categories among the data:\n";
 
-            std::cout << Color::tcolor( msg.str(), Color::GREEN, Color::BOLD ) << std::endl;
+            out << Color::tcolor( msg.str(), Color::GREEN, Color::BOLD ) << std::endl;
 
             msg.str( string() ); // resets buffer
 
-            for ( auto cat : this->categories ) // prints all categories
+            for ( auto id : this->sorted ) // prints all categories
             { 
-                msg << "[" << cat.first << "]"; 
-                std::cout << Color::tcolor( msg.str(), ( single_colored ? Color::RED : cat.second ), Color::BOLD ); // either the category color or a single color
-                std::cout << " ";
+                msg << "[" << this->categories[id] << "]"; 
+                out << this->palette.paint( msg.str(), id, true );
+                out << " ";
                 msg.str( string() ); // resets buffer    
             }
 
-            std::cout << Color::tcolor( "\n\n>>> Press ENTER to begin the race: \n", Color::BLUE, Color::BOLD );
+            out << Color::tcolor( "\n\n>>> Press ENTER to begin the race: \n", Color::BLUE, Color::BOLD );
         }
 
         //! Display the categories and its colors as a legend
-        /*! This method prints the categories and its mapped colors, as a legend, in the format "Color: category".
-         *  If `singe_color` is true, it'll print only a single color (red) and the category "All", informing us that all
-         *  the categories will be mapped to the same color, due to lack of colors to represent everything.
+        /*! This method draws the categories and its mapped colors, as a legend, in the format "Color: category".
+         *
+         *  @param sink Where the legend is drawn
          */
-        void display_categories( void )
+        void display_categories( bcr::Sink &sink )
         {
-            std::stringstream msg;
-            
-            if ( single_colored )
-            {
-                msg << Color::UNIT << ": All";
-                std::cout << Color::tcolor( msg.str(), Color::RED ) << std::endl;
-                return;
-            }
-
-
-            for ( auto cat : this->categories )
-            {
-                msg << Color::UNIT << ": " << cat.first;
-                std::cout << Color::tcolor( msg.str(), cat.second, Color::BOLD ) << "  ";
-                msg.str( string() );
-            }
-            std::cout << std::endl;
+            for ( auto id : this->sorted )
+                sink.legend( this->categories[id], id, this->palette.color( id ) );
         }
 
         //! Display header of the dataset
-        /*! This method prints the header of the current chart, printing the title (which is the same for every chart)
+        /*! This method draws the header of the current chart, i.e. the title (which is the same for every chart)
          *  and the current timestamp.
+         *
+         *  @param timestamp The timestamp of the current chart
+         *  @param sink Where the header is drawn
+         */
+        void display_header( const string &timestamp, bcr::Sink &sink )
+        {
+            sink.header( this->title, timestamp );
+        }
+
+        //! Display a chart
+        /*! This method draws a whole frame: the header, the chart, its footer and the legend.
+         *
+         *  @param chart Pointer to a prepared chart
+         *  @param sink Where the frame is drawn
+         *  @param last Whether this is the last frame of the race
          */
-        void display_header( string timestamp )
+        void display_chart( BarChart< Value > *chart, bcr::Sink &sink, bool last )
         {
-            std::cout << std::endl;
-            std::cout << std::setw( 80 - ( this->title.length() / 2 ) ) << "" << Color::tcolor( this->title, Color::WHITE, Color::BOLD ) << std::endl << std::endl; 
-            std::cout << std::setw( 75 - ( timestamp.length() / 2 ) ) << "" 
-                      << Color::tcolor( "Timestamp: ", Color::WHITE, Color::BOLD ) 
-                      << Color::tcolor( timestamp, Color::WHITE, Color::BOLD ) << std::endl << std::endl;
+            this->display_header( chart->get_timestamp(), sink );
+            chart->print_chart( this, sink );
+            chart->print_footer( this->label, this->source, sink );
+            this->display_categories( sink );
+            sink.end_frame( last );
         }
 };
 
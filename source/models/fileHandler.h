@@ -9,22 +9,74 @@
  */
 
 #include "../utils/common.h"
+#include "../utils/tokenizer.h"
+#include "../utils/filter.h"
 #include "barChart.h"
 #include "dataset.h"
 
+#include <memory>
+
 class FileHandler
 {
     private:
         string fname; // name of file
+        Filter filter; // lines kept in the race
+
+        static constexpr size_t CHUNK{ 1 << 20 }; // bytes read from the file at a time
+
+        // whether the line [first, last) is empty, ignoring a '\r' before the line break
+        static bool is_empty( const string &buffer, size_t first, size_t last )
+        {
+            return ( last == first ) or ( last == first + 1 and buffer[first] == '\r' );
+        }
+
+        // offset just past the first empty line at or after `from`, or npos if there's none
+        static size_t past_first_empty( const string &buffer, size_t from )
+        {
+            for ( size_t nl; ( nl = buffer.find( '\n', from ) ) != string::npos; from = nl + 1 )
+                if ( is_empty( buffer, from, nl ) )
+                    return nl + 1;
+            return string::npos;
+        }
+
+        // offset just past the last empty line at or after `from`, or npos if there's none
+        static size_t past_last_empty( const string &buffer, size_t from )
+        {
+            size_t nl = buffer.rfind( '\n' );
+            while ( nl != string::npos and nl >= from )
+            {
+                size_t first = ( nl == 0 ) ? 0 : buffer.rfind( '\n', nl - 1 ) + 1; // npos + 1 wraps to 0
+                if ( first < from )
+                    break;
+                if ( is_empty( buffer, first, nl ) )
+                    return nl + 1;
+                if ( first == 0 )
+                    break;
+                nl = first - 1;
+            }
+            return string::npos;
+        }
+
+        // appends up to CHUNK more bytes of `f` to `buffer`, returning false once the file is over
+        static bool read_chunk( std::ifstream &f, string &buffer )
+        {
+            size_t old = buffer.size();
+            buffer.resize( old + CHUNK );
+            f.read( &buffer[old], CHUNK );
+            buffer.resize( old + f.gcount() );
+
+            return bool( f );
+        }
 
     public:
         //! Constructor
         /*! Constructor method.
-         *  Sets the `fname`
+         *  Sets the `fname` and the `filter`
          *
          *  @param path String with the filepath
+         *  @param f Filter picking which lines of the data are kept; by default, all are
          */
-        FileHandler( string const &path ) : fname{ path }
+        FileHandler( string const &path, Filter f = Filter() ) : fname{ path }, filter{ std::move( f ) }
         { /* empty */ }
 
         //! Check file
@@ -51,7 +103,8 @@ class FileHandler
          *
          *  @return True if all header info is present, false otherwise
          */
-        bool get_header( Dataset *ds )
+        template < typename Value >
+        bool get_header( Dataset< Value > *ds )
         {
             std::ifstream f( this->fname );
 
@@ -75,95 +128,197 @@ class FileHandler
         /*! This method gets all the data we need to form our charts.
          *  It reads an integer n_bars, informing us of how many lines of data will follow after for each of the
          *  charts; each chart is separated by an empty line, starting with the n_bars integer.
-         *  This method will return false if we read a n_bars integer and read less datalines than what it was informed.
+         *  This method will return false if we read a n_bars integer and read less datalines than what it was informed,
+         *  or if a number can't be read.
+         *
+         *  The file is read in chunks of 1 MiB, each parsed up to its last empty line, so only whole charts are parsed at a time
+         *  and at most a chunk and an unfinished chart are kept in memory. Lines and fields are found with the vectorized
+         *  `Tokenizer::Scanner`, so no line is copied before being split. The values of each chart are gathered and converted together
+         *  once the chart is complete, with the parser matching `Value`.
+         *
+         *  Lines rejected by the `filter` are dropped as soon as the field that rejects them is found, before their bar is built
+         *  or their category is inserted, and charts left with no bars are dropped as well.
          *
          *  @param ds Pointer to the dataset in which we'll store the charts
          *  @param max_bar Max number of bars from the running options; we'll use to compare with each n_bars got, so we can always use whichever is smaller
          *  
          *  @return True if everything is OK with the file info, false otherwise
          */
-        bool get_data( Dataset *ds, unsigned int max_bar )
+        template < typename Value >
+        bool get_data( Dataset< Value > *ds, unsigned int max_bar )
         {
-            std::ifstream f( this->fname );
-            string line;
-            BarChart *chart = nullptr; // starts as a null pointer
+            return read_data( ds, max_bar, [ds]( BarChart< Value > *chart ) { ds->push_a_chart( chart ); } );
+        }
 
-            while ( std::getline( f, line ) )
-                if (line.empty()) // skipping header info
-                    break;
+        //! Reads all data, chart by chart
+        /*! This method works just like `get_data()`, but instead of storing each chart into the dataset,
+         *  it hands each one, unprepared, to `on_chart` as soon as its chunk is parsed, long before the rest of the file is read.
+         *  The categories are still inserted into the dataset.
+         *
+         *  @param ds Pointer to the dataset in which we'll store the categories
+         *  @param max_bar Max number of bars from the running options
+         *  @param on_chart Callable receiving a pointer to each chart read, in file order
+         *
+         *  @return True if everything is OK with the file info, false otherwise
+         */
+        template < typename Value, typename OnChart >
+        bool read_data( Dataset< Value > *ds, unsigned int max_bar, OnChart on_chart )
+        {
+            std::ifstream f( this->fname, std::ios::binary );
+            if ( not f.good() )
+                return false;
+
+            std::unique_ptr< BarChart< Value > > chart; // the chart being read; owned here until handed over, so an error never leaks it
+            std::vector< Bar< Value > > bars; // bars of the chart being read
+            std::vector< Tokenizer::Field > values; // their value fields, converted when the chart is complete
+            std::vector< Value > converted;
+            Tokenizer::Field stamp{ nullptr, nullptr }; // timestamp of the chart, taken from its last line
+            string category; // reused for every line, so looking a category up doesn't allocate
+
+            // converts the gathered values and hands the chart over
+            auto flush = [&]( void ) -> bool
+            {
+                if ( bars.empty() ) // every line was filtered out
+                {
+                    chart.reset();
+                    stamp = { nullptr, nullptr };
+                    return true;
+                }
+
+                // now we compare the bars read with max_bar, setting the chart's n_bars as whichever is smaller
+                // we do so because if max_bar > n_bars, it'll cause an error, since there is no sufficient number of bars to work with
+                chart->set_n_bars( std::min< size_t >( max_bar, bars.size() ) );
+
+                converted.resize( values.size() );
+                if ( not Tokenizer::parse_column( values, converted.data() ) )
+                    return false;
+
+                for ( size_t i = 0; i < bars.size(); i++ )
+                {
+                    bars[i].value = converted[i];
+                    chart->push_a_bar( std::move( bars[i] ) );
+                }
+
+                if ( stamp.first != nullptr )
+                    chart->set_timestamp( string( stamp.first, stamp.last ) );
+
+                on_chart( chart.release() );
+                bars.clear();
+                values.clear();
+                stamp = { nullptr, nullptr };
+                return true;
+            };
 
             int n_bars = 0;
-            while ( std::getline(f, line) )
-            { 
-                if ( line.empty() and n_bars > 0 )
-                    return false; // means we expected n_bars, but got a whitespace before, meaning less bars than expected
+            array< size_t, 5 > commas; // the commas delimiting the first five fields
 
-                if ( line.empty() and chart == nullptr ) // empty line to delimiter the charts
-                    continue;
+            // reads the charts in [data, data + size), which always ends right after an empty line, or at the end of the file
+            auto parse = [&]( const char *data, size_t size ) -> bool
+            {
+                Tokenizer::Scanner scanner( data, size );
+                size_t line = 0; // start of the current line
 
-                if ( n_bars == 0 ) // if no n_bars is set yet, or if we already ran over n_bars lines
+                while ( line < size )
                 {
-                    if ( chart != nullptr )
-                        ds->push_a_chart( chart ); // push a chart to the dataset
+                    // finds the end of the line, taking note of the commas along the way
+                    size_t n_commas = 0, end;
+                    while ( ( end = scanner.next() ) < size and data[end] == ',' )
+                        if ( n_commas < commas.size() )
+                            commas[n_commas++] = end;
 
-                    if ( not line.empty() )
+                    size_t next = end + 1;
+                    if ( end > line and data[end - 1] == '\r' )
+                        end--;
+
+                    if ( end == line ) // empty line
                     {
-                        n_bars = std::stoi( line ); // gets a new n_bars
-                        chart = new BarChart(); // resets the chart pointer
-                    
-                        // now we compare n_bars with max_bar, setting the chart's n_bars as whichever is smaller
-                        // we do so because if max_bar > n_bars, it'll cause an error, since there is no sufficient number of bars to work with
-                        if ( max_bar > n_bars )
-                            chart->set_n_bars( n_bars );
-                        else
-                            chart->set_n_bars( max_bar );
+                        if ( n_bars > 0 )
+                            return false; // means we expected n_bars, but got a whitespace before, meaning less bars than expected
+
+                        if ( chart != nullptr and not flush() ) // empty line to delimiter the charts
+                            return false;
                     }
+                    else if ( n_bars == 0 ) // if no n_bars is set yet, or if we already ran over n_bars lines
+                    {
+                        if ( chart != nullptr and not flush() )
+                            return false;
 
-                    continue;
-                }
+                        if ( not Tokenizer::parse_integer( data + line, data + end, n_bars ) or n_bars < 0 )
+                            return false;
+
+                        chart.reset( new BarChart< Value >() ); // resets the chart pointer
+                    }
+                    else
+                    {
+                        // the info on each line (bar) is separated by commas: timestamp,label,(unused),value,category
+                        if ( n_commas < 3 )
+                            return false;
 
-                
-                Bar bar; // a new bar
-                int pos = 0;
-                char token = ','; // the info on each line (bar) is separated by commas
+                        --n_bars; // we have now less one bar to read
 
-                std::stringstream ss( line ); // to separate
-                string str;
+                        size_t value_end = ( n_commas > 3 ) ? commas[3] : end;
+                        size_t cat_first = ( n_commas > 3 ) ? commas[3] + 1 : end;
+                        size_t cat_end = ( n_commas > 4 ) ? commas[4] : end;
 
-                while ( std::getline( ss, str, token ) ) // while we can separate by comma
-                {
-                    switch( pos++ )
-                    {
-                        case 0: // first position is the chart's timestamp
-                        {
-                            chart->set_timestamp( str );
-                            break;
-                        }
-                        case 1: // second position is the label for the bar
-                        {
-                            bar.label = str;
-                            break;
-                        }
-                        case 3: // third position is the value; skipping second position as we dont need it
-                        {
-                            bar.value = std::stoi( str );
-                            break;
-                        }
-                        case 4: // fourth position is the bar's category
+                        // cheapest checks first; a rejected line costs nothing past this point
+                        if ( this->filter.keeps_timestamp( data + line, data + commas[0] )
+                             and this->filter.keeps_category( data + cat_first, data + cat_end )
+                             and this->filter.keeps_label( data + commas[0] + 1, data + commas[1] ) )
                         {
-                            bar.category = str;
-                            ds->push_a_category( str ); // pushes the category, but only if it doesn't exisits already
-                            break;
+                            stamp = { data + line, data + commas[0] }; // first position is the chart's timestamp
+
+                            Bar< Value > bar; // a new bar
+                            bar.label.assign( data + commas[0] + 1, commas[1] - commas[0] - 1 ); // second position is the label for the bar
+                            values.push_back( { data + commas[2] + 1, data + value_end } ); // fourth position is the value; skipping the third as we dont need it
+
+                            category.assign( data + cat_first, cat_end - cat_first ); // fifth position is the bar's category
+                            bar.category = ds->push_a_category( category ); // pushes the category, but only if it doesn't exisits already
+
+                            bars.push_back( std::move( bar ) );
                         }
                     }
+
+                    line = next;
+                }
+
+                return true;
+            };
+
+            string buffer; // read, but not parsed yet
+            bool more = read_chunk( f, buffer );
+
+            // skipping header info, up to the first empty line
+            size_t pos;
+            while ( ( pos = past_first_empty( buffer, 0 ) ) == string::npos and more )
+                more = read_chunk( f, buffer );
+
+            if ( pos == string::npos ) // there's nothing but the header
+                return true;
+
+            // the charts are parsed a chunk at a time, each cut after its last empty line, so a chart is never split between chunks
+            for ( ;; )
+            {
+                size_t end = more ? past_last_empty( buffer, pos ) : buffer.size();
+
+                if ( end != string::npos )
+                {
+                    if ( not parse( buffer.data() + pos, end - pos ) )
+                        return false;
+                    pos = end;
                 }
-                chart->push_a_bar( bar ); // after we populate the bar, push it to the chart
-                --n_bars; // we have now less one bar to read
+
+                if ( not more )
+                    break;
+
+                buffer.erase( 0, pos ); // keeps the unfinished chart, if any
+                pos = 0;
+                more = read_chunk( f, buffer );
             }
 
-            f.close();
+            if ( n_bars > 0 )
+                return false;
 
-            return true;
+            return chart == nullptr or flush();
         }
 };
 
@@ -0,0 +1,251 @@
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+/*!
+ *  This file contains a class to run the race as a pipeline of three stages, each on its own thread:
+ *  parsing the file, preparing each chart (sorting, purging and setting widths) and rendering it.
+ *  The stages are connected by lock-free queues of limited depth, so a fast stage waits for a slow one
+ *  instead of piling up charts in memory.
+ *
+ *  @author Lucas Bazante
+ *  @file pipeline.h
+ */
+
+#include "../utils/common.h"
+#include "../utils/text_color.h"
+#include "../utils/spsc_queue.h"
+#include "dataset.h"
+#include "barChart.h"
+#include "fileHandler.h"
+#include "sink.h"
+
+#include <atomic>
+#include <unordered_set>
+
+template < typename Value >
+class Pipeline
+{
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        // an item traveling through the stages
+        struct Frame
+        {
+            BarChart< Value > *chart; // the chart; nullptr marks the end of the race
+            std::vector< string > categories; // categories first found while reading this chart
+        };
+
+        // how a stage spent its time, in seconds
+        struct Metrics
+        {
+            string name;
+            size_t charts{ 0 }; // charts handled
+            double total{ 0 };   // from start to finish
+            double starved{ 0 }; // waiting for the previous stage
+            double blocked{ 0 }; // waiting for room on the next stage
+            double paced{ 0 };   // sleeping to keep the FPS
+
+            double busy( void ) const
+            {
+                return total - starved - blocked - paced;
+            }
+        };
+
+        FileHandler &handler; // reads the file
+        Dataset< Value > *ds; // parse side dataset, holding the categories as they are read
+        Dataset< Value > view; // render side dataset, a copy of the header info and of the categories found so far
+        Options op; // running options
+
+        SpscQueue< Frame > parsed; // parse -> prepare
+        SpscQueue< Frame > prepared; // prepare -> render
+
+        array< Metrics, 3 > metrics{ { { "parse" }, { "prepare" }, { "render" } } };
+        double wall{ 0 }; // seconds the whole pipeline took
+        std::atomic< bool > failed{ false }; // whether the file has corrupted information
+
+        // seconds elapsed since `start`
+        static double since( clock::time_point start )
+        {
+            return std::chrono::duration< double >( clock::now() - start ).count();
+        }
+
+        // pushes a frame, waiting while the queue is full
+        static void push( SpscQueue< Frame > &queue, const Frame &frame, Metrics &m )
+        {
+            if ( queue.try_push( frame ) )
+                return;
+
+            auto start = clock::now();
+            queue.push( frame );
+            m.blocked += since( start );
+        }
+
+        // pops a frame, waiting while the queue is empty
+        static Frame pop( SpscQueue< Frame > &queue, Metrics &m )
+        {
+            Frame frame;
+            if ( queue.try_pop( frame ) )
+                return frame;
+
+            auto start = clock::now();
+            queue.pop( frame );
+            m.starved += since( start );
+
+            return frame;
+        }
+
+        // first stage: reads each chart, along with the categories it introduced
+        // there's no sorting here, so the charts are raced in file order
+        void parse( void )
+        {
+            auto start = clock::now();
+            Metrics &m = this->metrics[0];
+            size_t seen = 0; // categories already sent down the pipeline
+            std::unordered_set< string > stamps; // timestamps already sent down the pipeline
+
+            bool ok = this->handler.read_data( this->ds, this->op.max_bar, [&]( BarChart< Value > *chart )
+            {
+                if ( not stamps.insert( chart->get_timestamp() ).second ) // just like the dataset, only the first chart of a timestamp is kept
+                {
+                    delete chart;
+                    return;
+                }
+
+                Frame frame{ chart, {} };
+                for ( ; seen < this->ds->n_categories(); seen++ )
+                    frame.categories.push_back( this->ds->get_category( seen ) );
+
+                push( this->parsed, frame, m );
+                m.charts++;
+            } );
+
+            if ( not ok )
+                this->failed = true;
+
+            push( this->parsed, Frame{ nullptr, {} }, m ); // end of the race
+            m.total = since( start );
+        }
+
+        // second stage: sorts, purges and sets the widths of each chart
+        void prepare( void )
+        {
+            auto start = clock::now();
+            Metrics &m = this->metrics[1];
+
+            for ( ;; )
+            {
+                Frame frame = pop( this->parsed, m );
+
+                if ( frame.chart != nullptr )
+                {
+                    frame.chart->prepare();
+                    m.charts++;
+                }
+
+                push( this->prepared, frame, m );
+
+                if ( frame.chart == nullptr )
+                    break;
+            }
+
+            m.total = since( start );
+        }
+
+        // third stage: prints each chart, keeping the FPS
+        void render( void )
+        {
+            auto start = clock::now();
+            Metrics &m = this->metrics[2];
+            bcr::TextSink terminal( std::cout, this->op.fps );
+
+            Frame current = pop( this->prepared, m );
+
+            while ( current.chart != nullptr )
+            {
+                for ( auto &category : current.categories )
+                    this->view.push_a_category( category );
+
+                Frame next = pop( this->prepared, m ); // we need to know if this is the last one
+
+                this->view.display_chart( current.chart, terminal, next.chart == nullptr );
+
+                delete current.chart;
+                m.charts++;
+
+                current = next;
+            }
+
+            m.paced = terminal.get_slept();
+            m.total = since( start );
+        }
+
+    public:
+        //! Constructor
+        /*! Constructor method.
+         *  Sets up the queues with the depths from the running options.
+         *
+         *  @param h The handler of the data file
+         *  @param d Pointer to a dataset with the header info already set
+         *  @param o The running options
+         */
+        Pipeline( FileHandler &h, Dataset< Value > *d, Options o )
+            : handler{ h }, ds{ d }, view( o.truecolor ), op{ o }, parsed( o.parse_depth ), prepared( o.render_depth )
+        {
+            this->view.set_info( d->get_title(), d->get_label(), d->get_source() );
+        }
+
+        //! Runs the race
+        /*! This method starts the three stages, each on its own thread, and waits until all of them are done.
+         *
+         *  @return True if the whole file was read fine, false if it contains corrupted information
+         */
+        bool run( void )
+        {
+            auto start = clock::now();
+
+            std::thread parser( &Pipeline::parse, this );
+            std::thread preparer( &Pipeline::prepare, this );
+            std::thread renderer( &Pipeline::render, this );
+
+            parser.join();
+            preparer.join();
+            renderer.join();
+
+            this->wall = since( start );
+
+            return not this->failed;
+        }
+
+        //! Display stage metrics
+        /*! This method prints, for each stage, the share of the whole run it spent working, waiting for the previous stage,
+         *  waiting for the next stage and sleeping to keep the FPS; a stage that finished early is idle for the rest.
+         *  The stage busy for the larger share is the bottleneck.
+         */
+        void display_metrics( void )
+        {
+            std::stringstream msg;
+            msg << "\n>>> Stage       busy   starved   blocked   paced   charts\n";
+
+            const Metrics *bottleneck = &this->metrics[0];
+            double wall = ( this->wall > 0 ) ? this->wall : 1;
+
+            for ( auto &m : this->metrics )
+            {
+                msg << ">>> " << std::left << std::setw( 8 ) << m.name << std::right << std::fixed << std::setprecision( 1 )
+                    << std::setw( 7 ) << 100 * m.busy() / wall << "%"
+                    << std::setw( 9 ) << 100 * m.starved / wall << "%"
+                    << std::setw( 9 ) << 100 * m.blocked / wall << "%"
+                    << std::setw( 7 ) << 100 * m.paced / wall << "%"
+                    << std::setw( 9 ) << m.charts << "\n";
+
+                if ( m.busy() > bottleneck->busy() )
+                    bottleneck = &m;
+            }
+
+            msg << "\n>>> Bottleneck: " << bottleneck->name;
+
+            std::cout << Color::tcolor( msg.str(), Color::GREEN, Color::BOLD ) << std::endl;
+        }
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*!
+ * Implementation of the text sink, kept out of sink.h so the library interface doesn't depend on the colors.
+ *
+ * @author Lucas Bazante
+ * @file sink.cpp
+ */
+
+#include "sink.h"
+
+// utils
+#include "../utils/common.h"
+#include "../utils/text_color.h"
+#include "../utils/palette.h"
+
+namespace bcr {
+
+    const string &TextSink::prefix( unsigned int id, const CategoryColor &color, bool is_bold )
+    {
+        if ( id >= this->colors.size() )
+        {
+            this->colors.resize( id + 1 );
+            this->regular.resize( id + 1 );
+            this->bold.resize( id + 1 );
+        }
+
+        if ( this->regular[id].empty() or not ( this->colors[id] == color ) ) // first time, or a new race with other colors
+        {
+            this->colors[id] = color;
+            this->regular[id] = Palette::escape( color );
+            this->bold[id] = Palette::escape( color, true );
+        }
+
+        return is_bold ? this->bold[id] : this->regular[id];
+    }
+
+    void TextSink::header( const string &title, const string &timestamp )
+    {
+        this->out << std::endl;
+        this->out << std::setw( 80 - ( title.length() / 2 ) ) << "" << Color::tcolor( title, Color::WHITE, Color::BOLD ) << std::endl << std::endl;
+        this->out << std::setw( 75 - ( timestamp.length() / 2 ) ) << ""
+                  << Color::tcolor( "Timestamp: ", Color::WHITE, Color::BOLD )
+                  << Color::tcolor( timestamp, Color::WHITE, Color::BOLD ) << std::endl << std::endl;
+    }
+
+    void TextSink::bar( const string &label, const string &, unsigned int id, const CategoryColor &color, const string &value, unsigned char width )
+    {
+        const string &open = prefix( id, color, false );
+
+        this->out << open;
+        this->out.write( Color::FULL_BAR.data(), width * Color::UNIT.size() ); // every bar is a prefix of the full one
+        this->out << Color::RESET << " " << open << label << Color::RESET << " [" << value << "]" << std::endl << std::endl; // print label [value]
+    }
+
+    void TextSink::footer( const string &axis, const string &points, const std::vector< Tick > &, const string &label, const string &source )
+    {
+        this->out << axis << std::endl << Color::tcolor( points, Color::YELLOW ) << std::endl;
+        this->out << Color::tcolor( label, Color::YELLOW, Color::BOLD ) << std::endl << std::endl;
+        this->out << Color::tcolor( source, Color::WHITE, Color::BOLD ) << std::endl;
+    }
+
+    void TextSink::legend( const string &category, unsigned int id, const CategoryColor &color )
+    {
+        this->out << prefix( id, color, true ) << Color::UNIT << ": " << category << Color::RESET << "  ";
+    }
+
+    void TextSink::end_frame( bool last )
+    {
+        this->out << std::endl; // ends the legend
+
+        if ( this->fps > 0 )
+        {
+            if ( not last ) // only flushes screen if its not the last one
+                this->out << "\033[2J\033[1;1H";
+
+            auto start = std::chrono::steady_clock::now();
+            std::this_thread::sleep_for( std::chrono::milliseconds{ 1000 / this->fps } );
+            this->slept += std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+        }
+
+        this->out << std::endl;
+    }
+}
@@ -0,0 +1,249 @@
+#ifndef _SINK_H_
+#define _SINK_H_
+
+/*!
+ *  This file contains the interface through which a frame of the race is drawn, along with its implementations:
+ *  text written to any stream (the terminal, with its FPS, or an in-memory buffer), and a structured frame handed to a callback.
+ *
+ *  A frame is drawn by a call to `header()`, one to `bar()` per bar, one to `footer()`, one to `legend()` per category,
+ *  and finally one to `end_frame()`.
+ *
+ *  It is part of the library interface, so it only depends on the standard library; the text is drawn in sink.cpp.
+ *  Colors are handed to the sinks as palette codes, and only `TextSink` turns them into terminal escape sequences.
+ *
+ *  @author Lucas Bazante
+ *  @file sink.h
+ */
+
+#include <functional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bcr {
+
+    // a mark on the x-axis
+    struct Tick
+    {
+        std::string text; // the value, as printed
+        int width; // where it is, from 0 up to the full bar width of 150
+    };
+
+    // the color of a category, as a palette code
+    struct CategoryColor
+    {
+        enum Kind
+        {
+            BASIC,   // one of the 16 basic terminal colors
+            INDEXED, // one of the 256-color palette
+            RGB      // a 24-bit color
+        };
+
+        Kind kind{ BASIC };
+        short code{ 37 }; // BASIC: the foreground code, 30 up to 37 or 90 up to 97; INDEXED: the index, 0 up to 255; RGB: 0
+        unsigned char red{ 0 }, green{ 0 }, blue{ 0 }; // RGB only
+
+        bool operator==( const CategoryColor &other ) const
+        {
+            return kind == other.kind and code == other.code and red == other.red and green == other.green and blue == other.blue;
+        }
+    };
+
+    class Sink
+    {
+        public:
+            virtual ~Sink( void ) = default;
+
+            //! Draws the header
+            /*! @param title The title of the race
+             *  @param timestamp The timestamp of the frame
+             */
+            virtual void header( const std::string &title, const std::string &timestamp ) = 0;
+
+            //! Draws a bar
+            /*! @param label The bar's label
+             *  @param category The bar's category
+             *  @param id The id of the category, the same for the whole race
+             *  @param color The color of the category
+             *  @param value The bar's value, as printed
+             *  @param width The bar's width, from 0 up to 150
+             */
+            virtual void bar( const std::string &label, const std::string &category, unsigned int id, const CategoryColor &color, const std::string &value, unsigned char width ) = 0;
+
+            //! Draws the footer
+            /*! @param axis The x-axis, as text
+             *  @param points The values marked on the axis, aligned with it, as text
+             *  @param ticks The values marked on the axis
+             *  @param label The label of the values
+             *  @param source The source of the data
+             */
+            virtual void footer( const std::string &axis, const std::string &points, const std::vector< Tick > &ticks, const std::string &label, const std::string &source ) = 0;
+
+            //! Draws a legend entry
+            /*! @param category The category
+             *  @param id The id of the category, the same for the whole race
+             *  @param color The color of the category
+             */
+            virtual void legend( const std::string &category, unsigned int id, const CategoryColor &color ) = 0;
+
+            //! Ends the frame
+            /*! @param last Whether this is the last frame of the race
+             */
+            virtual void end_frame( bool last ) = 0;
+    };
+
+    //! Sink writing frames as colored text to a stream
+    /*! When given a FPS, it also behaves as a terminal: it waits between frames and clears the screen before the next one.
+     */
+    class TextSink : public Sink
+    {
+        private:
+            std::ostream &out; // where the text goes
+            unsigned int fps; // frames per second; 0 means no waiting and no clearing
+            double slept{ 0 }; // seconds spent waiting between frames
+
+            std::vector< CategoryColor > colors; // the color of each category id drawn so far
+            std::vector< std::string > regular, bold; // their escape sequences, built the first time each id is drawn
+
+            // escape sequence opening a text colored as the category
+            const std::string &prefix( unsigned int id, const CategoryColor &color, bool is_bold );
+
+        public:
+            //! Constructor
+            /*! Constructor method.
+             *
+             *  @param o The stream to write to
+             *  @param f The frames per second, or 0 to write frames as fast as they come
+             */
+            TextSink( std::ostream &o, unsigned int f = 0 ) : out{ o }, fps{ f }
+            { /* empty */ }
+
+            void header( const std::string &title, const std::string &timestamp ) override;
+            void bar( const std::string &label, const std::string &category, unsigned int id, const CategoryColor &color, const std::string &value, unsigned char width ) override;
+            void footer( const std::string &axis, const std::string &points, const std::vector< Tick > &ticks, const std::string &label, const std::string &source ) override;
+            void legend( const std::string &category, unsigned int id, const CategoryColor &color ) override;
+            void end_frame( bool last ) override;
+
+            //! Gets the time spent waiting
+            /*! @return Seconds spent waiting between frames, to keep the FPS.
+             */
+            double get_slept( void )
+            {
+                return this->slept;
+            }
+    };
+
+    //! Sink keeping the frames as text in memory
+    class BufferSink : public TextSink
+    {
+        private:
+            std::ostringstream buffer; // the text of the frames drawn so far
+
+        public:
+            BufferSink( void ) : TextSink( buffer )
+            { /* empty */ }
+
+            //! Gets the text
+            /*! @return The text of every frame drawn since the last `clear()`.
+             */
+            std::string str( void ) const
+            {
+                return this->buffer.str();
+            }
+
+            //! Clears the text
+            void clear( void )
+            {
+                this->buffer.str( std::string() );
+            }
+    };
+
+    // a bar, as drawn
+    struct FrameBar
+    {
+        std::string label;
+        std::string category;
+        unsigned int id; // of the category
+        CategoryColor color; // of the category
+        std::string value; // as printed
+        unsigned char width; // 0 up to 150
+    };
+
+    // a category of the legend
+    struct FrameCategory
+    {
+        std::string name;
+        unsigned int id;
+        CategoryColor color;
+    };
+
+    // a whole frame, as drawn
+    struct FrameData
+    {
+        std::string title;
+        std::string timestamp;
+        std::vector< FrameBar > bars;
+        std::string axis; // as text
+        std::string points; // as text
+        std::vector< Tick > ticks;
+        std::string label;
+        std::string source;
+        std::vector< FrameCategory > categories; // the legend
+        bool last{ false };
+    };
+
+    //! Sink handing each frame, as data, to a callback
+    /*! The frame given to the callback is reused for the next one, so it's only valid during the call.
+     */
+    class CallbackSink : public Sink
+    {
+        private:
+            std::function< void( const FrameData & ) > callback; // called once per frame
+            FrameData frame; // the frame being drawn
+
+        public:
+            //! Constructor
+            /*! Constructor method.
+             *
+             *  @param cb The callable receiving each frame
+             */
+            CallbackSink( std::function< void( const FrameData & ) > cb ) : callback{ std::move( cb ) }
+            { /* empty */ }
+
+            void header( const std::string &title, const std::string &timestamp ) override
+            {
+                this->frame.title = title;
+                this->frame.timestamp = timestamp;
+                this->frame.bars.clear();
+                this->frame.categories.clear();
+            }
+
+            void bar( const std::string &label, const std::string &category, unsigned int id, const CategoryColor &color, const std::string &value, unsigned char width ) override
+            {
+                this->frame.bars.push_back( { label, category, id, color, value, width } );
+            }
+
+            void footer( const std::string &axis, const std::string &points, const std::vector< Tick > &ticks, const std::string &label, const std::string &source ) override
+            {
+                this->frame.axis = axis;
+                this->frame.points = points;
+                this->frame.ticks = ticks;
+                this->frame.label = label;
+                this->frame.source = source;
+            }
+
+            void legend( const std::string &category, unsigned int id, const CategoryColor &color ) override
+            {
+                this->frame.categories.push_back( { category, id, color } );
+            }
+
+            void end_frame( bool last ) override
+            {
+                this->frame.last = last;
+                this->callback( this->frame );
+            }
+    };
+}
+
+#endif
@@ -21,18 +21,21 @@
 #include <thread>
 #include <map>
 #include <cmath>
+#include <cstdint>
+#include <type_traits>
 
 using std::ostringstream;
 using std::string;
 using std::array;
 
-// struct for a bar item
+// struct for a bar item, with values of type `Value` (int64_t or double)
+template < typename Value >
 struct Bar
 {
     string label;
-    string category;
-    int value;
-    float width;
+    unsigned int category; // id of the category in the dataset
+    Value value;
+    unsigned char width{ 0 }; // 0 up to 150, the full width
 };
 
 // struct for running options
@@ -40,13 +43,24 @@ struct Options
 {
     unsigned int max_bar{ 5 }; // maximum number of bars
     unsigned int fps{ 24 };    // FPS animation speed
+    bool real{ false };        // whether values are floating-point instead of integers
+    bool truecolor{ false };   // whether categories past the 15th get 24-bit colors
+    unsigned int threads{ 0 }; // threads preparing the charts; 0 means one per core
+    bool pipelined{ false };   // whether parsing, preparation and rendering run on their own threads
+    unsigned int parse_depth{ 64 };  // charts the parse stage may read ahead of the prepare stage
+    unsigned int render_depth{ 8 };  // charts the prepare stage may get ready ahead of the render stage
     string filepath;  // the data file path
+    std::vector< string > categories; // categories kept in the race, as lists separated by commas; all, if empty
+    string label_regex; // regex the labels kept must contain; all, if empty
+    string range; // timestamps kept, as "<from>..<to>"; all, if empty
 
     // tunes the options if it is wrongly chosen
     void tune_options( void )
     {
         max_bar = ( max_bar > 15 ) ? 15 : max_bar; // we cant have more than 15 bars
         fps = ( fps > 24 ) ? 24 : fps; // no more than 24 for fps
+        parse_depth = ( parse_depth < 1 ) ? 1 : parse_depth; // queues need room for at least one chart
+        render_depth = ( render_depth < 1 ) ? 1 : render_depth;
     }
 };
 
@@ -58,7 +72,8 @@ struct Options
  *
  *  @return True if a.value > b.value, false otherwise
  */
-inline bool cmp_bar( const Bar &a, const Bar &b )
+template < typename Value >
+inline bool cmp_bar( const Bar< Value > &a, const Bar< Value > &b )
 {
     return a.value > b.value;
 }  
@@ -0,0 +1,60 @@
+#ifndef _CPU_H_
+#define _CPU_H_
+
+/*!
+ *  Set of definitions about the target and the running CPU, shared by every vectorized routine.
+ *  `BCR_X86_SIMD` is defined when the x86 intrinsics can be built; whether the running CPU actually
+ *  supports them is checked once, at runtime, by the functions below.
+ *
+ *  @author Lucas Bazante
+ *  @file cpu.h
+ */
+
+#if defined( __GNUC__ ) and ( defined( __x86_64__ ) or defined( __i386__ ) )
+#ifndef BCR_X86_SIMD
+#define BCR_X86_SIMD 1
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined( __BYTE_ORDER__ ) and __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#ifndef BCR_LITTLE_ENDIAN
+#define BCR_LITTLE_ENDIAN 1 // whether the bytes of a word are laid out lowest first
+#endif
+#endif
+
+namespace Cpu {
+
+    // the instruction sets the vectorized routines pick from
+    enum Level
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    //! Gets the best instruction set
+    /*! This function gets the best instruction set supported by the running CPU, among those we have routines for.
+     *  The CPU is only checked on the first call.
+     *
+     *  @return The instruction set
+     */
+    inline Level level( void )
+    {
+        static const Level best = []( void ) -> Level
+        {
+#ifdef BCR_X86_SIMD
+            __builtin_cpu_init();
+            if ( __builtin_cpu_supports( "avx2" ) )
+                return AVX2;
+            if ( __builtin_cpu_supports( "sse2" ) )
+                return SSE2;
+#endif
+            return SCALAR;
+        }();
+
+        return best;
+    }
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef _FILTER_H_
+#define _FILTER_H_
+
+/*!
+ *  This file contains a class to pick which lines of the data are part of the race,
+ *  by category, by label and by timestamp. Its checks work straight on the fields of the file buffer,
+ *  so the parser can drop a line as soon as the relevant field is found, before building anything for it.
+ *
+ *  @author Lucas Bazante
+ *  @file filter.h
+ */
+
+#include "common.h"
+
+#include <regex>
+#include <string_view>
+
+class Filter
+{
+    private:
+        std::vector< string > categories; // categories kept, sorted; if empty, all are kept
+        bool has_pattern{ false }; // whether labels must match `pattern`
+        std::regex pattern; // regex a label must contain
+        string from; // first timestamp kept; if empty, there's no lower bound
+        string to; // last timestamp kept; if empty, there's no upper bound
+
+    public:
+        //! Constructor
+        /*! Constructor method. A default Filter keeps everything.
+         */
+        Filter( void )
+        { /* empty */ }
+
+        //! Constructor
+        /*! Constructor method.
+         *  Sets the filter from the running options. The categories are a list separated by commas,
+         *  and the range is in the format "<from>..<to>", where either bound may be left out.
+         *
+         *  @param op The running options
+         *
+         *  @throw std::regex_error if the label pattern is not a valid regex
+         */
+        Filter( const Options &op ) : has_pattern{ not op.label_regex.empty() }
+        {
+            for ( auto &list : op.categories ) // splitting by comma
+            {
+                std::stringstream ss( list );
+                string category;
+                while ( std::getline( ss, category, ',' ) )
+                    if ( not category.empty() )
+                        this->categories.push_back( category );
+            }
+            std::sort( this->categories.begin(), this->categories.end() );
+
+            if ( this->has_pattern )
+                this->pattern = std::regex( op.label_regex, std::regex::optimize );
+
+            size_t dots = op.range.find( ".." );
+            if ( dots != string::npos )
+            {
+                this->from = op.range.substr( 0, dots );
+                this->to = op.range.substr( dots + 2 );
+            }
+            else
+                this->from = this->to = op.range; // a single timestamp
+        }
+
+        //! Checks a timestamp
+        /*! This method checks if a timestamp is inside the range, comparing them as text,
+         *  which works for timestamps of fixed width, such as years or ISO dates.
+         *
+         *  @param first Pointer to the first character of the timestamp
+         *  @param last Pointer past its last character
+         *
+         *  @return True if the timestamp is kept, false otherwise
+         */
+        bool keeps_timestamp( const char *first, const char *last ) const
+        {
+            std::string_view ts( first, last - first );
+            return ( this->from.empty() or ts >= this->from ) and ( this->to.empty() or ts <= this->to );
+        }
+
+        //! Checks a category
+        /*! This method checks if a category is one of the chosen ones.
+         *
+         *  @param first Pointer to the first character of the category
+         *  @param last Pointer past its last character
+         *
+         *  @return True if the category is kept, false otherwise
+         */
+        bool keeps_category( const char *first, const char *last ) const
+        {
+            if ( this->categories.empty() )
+                return true;
+
+            std::string_view category( first, last - first );
+            return std::binary_search( this->categories.begin(), this->categories.end(), category, std::less<>() );
+        }
+
+        //! Checks a label
+        /*! This method checks if a label contains a match of the label pattern.
+         *
+         *  @param first Pointer to the first character of the label
+         *  @param last Pointer past its last character
+         *
+         *  @return True if the label is kept, false otherwise
+         */
+        bool keeps_label( const char *first, const char *last ) const
+        {
+            return not this->has_pattern or std::regex_search( first, last, this->pattern );
+        }
+};
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef _PALETTE_H_
+#define _PALETTE_H_
+
+/*!
+ *  This file contains a class to give a color to any number of categories.
+ *  The first 15 categories get the basic terminal colors; the next ones get colors from the 256-color cube,
+ *  or, in truecolor mode, evenly spread hues. Colors are kept as palette codes, `bcr::CategoryColor`, and their escape
+ *  sequences are built once, when the category is added, so coloring a text afterwards is only a vector access.
+ *
+ *  @author Lucas Bazante
+ *  @file palette.h
+ */
+
+#include "common.h"
+#include "text_color.h"
+#include "../models/sink.h"
+
+class Palette
+{
+    private:
+        bool truecolor; // whether colors past the basic ones are 24-bit instead of from the 256-color cube
+        std::vector< bcr::CategoryColor > colors; // the color, by category id
+        std::vector< string > regular; // escape sequence opening a regular text, by category id
+        std::vector< string > bold; // escape sequence opening a bold text, by category id
+
+        // basic colors, in the order they are given
+        static constexpr array< short, 15 > basic{
+            31, 32, 33, 34, 35, 36, 37,
+            90, 91, 92, 93, 94, 95, 96, 97
+        };
+
+        // color of the i-th category
+        bcr::CategoryColor color_of( size_t i ) const
+        {
+            bcr::CategoryColor color;
+
+            if ( i < basic.size() )
+            {
+                color.code = basic[i];
+                return color;
+            }
+
+            i -= basic.size();
+
+            if ( this->truecolor ) // walking the hue by the golden ratio keeps any two neighbors far apart
+            {
+                double h = std::fmod( i * 0.618033988749895, 1.0 ) * 6;
+                double s = 0.65, v = 0.95;
+                double f = h - std::floor( h );
+                double p = v * ( 1 - s ), q = v * ( 1 - s * f ), t = v * ( 1 - s * ( 1 - f ) );
+                double r, g, b;
+
+                switch ( int( h ) % 6 )
+                {
+                    case 0: r = v, g = t, b = p; break;
+                    case 1: r = q, g = v, b = p; break;
+                    case 2: r = p, g = v, b = t; break;
+                    case 3: r = p, g = q, b = v; break;
+                    case 4: r = t, g = p, b = v; break;
+                    default: r = v, g = p, b = q; break;
+                }
+
+                color.kind = bcr::CategoryColor::RGB;
+                color.code = 0;
+                color.red = r * 255, color.green = g * 255, color.blue = b * 255;
+                return color;
+            }
+
+            static const std::vector< short > cube = cube_order();
+            color.kind = bcr::CategoryColor::INDEXED;
+            color.code = cube[i % cube.size()];
+            return color;
+        }
+
+        // colors of the 6x6x6 cube (16 up to 231), skipping greys and the darkest ones,
+        // visited with a stride coprime to 216 so consecutive categories get distant colors
+        static std::vector< short > cube_order( void )
+        {
+            std::vector< short > order;
+
+            for ( int k = 0, n = 0; k < 216; k++, n = ( n + 97 ) % 216 )
+            {
+                int r = n / 36, g = ( n / 6 ) % 6, b = n % 6;
+                if ( ( r == g and g == b ) or std::max( { r, g, b } ) < 2 )
+                    continue;
+                order.push_back( 16 + n );
+            }
+
+            return order;
+        }
+
+    public:
+        //! Constructor
+        /*! Constructor method.
+         *
+         *  @param tc Whether to use 24-bit colors past the basic ones
+         */
+        Palette( bool tc = false ) : truecolor{ tc }
+        { /* empty */ }
+
+        //! Builds an escape sequence
+        /*! This function builds the escape sequence that opens a text of the given color.
+         *
+         *  @param color The color
+         *  @param is_bold Whether the text is bold
+         *
+         *  @return The escape sequence
+         */
+        static string escape( const bcr::CategoryColor &color, bool is_bold = false )
+        {
+            std::ostringstream oss;
+            oss << "\e[" << ( is_bold ? Color::BOLD : Color::REGULAR ) << ";";
+
+            switch ( color.kind )
+            {
+                case bcr::CategoryColor::BASIC: oss << color.code; break;
+                case bcr::CategoryColor::INDEXED: oss << "38;5;" << color.code; break;
+                case bcr::CategoryColor::RGB: oss << "38;2;" << int( color.red ) << ";" << int( color.green ) << ";" << int( color.blue ); break;
+            }
+
+            oss << "m";
+            return oss.str();
+        }
+
+        //! Adds a color
+        /*! This method picks the color, and builds its escape sequences, for the next category id.
+         *
+         *  @return The id the color was picked for
+         */
+        size_t add( void )
+        {
+            size_t id = this->colors.size();
+            bcr::CategoryColor c = color_of( id );
+
+            this->colors.push_back( c );
+            this->regular.push_back( escape( c ) );
+            this->bold.push_back( escape( c, true ) );
+
+            return id;
+        }
+
+        //! Gets the color of a category
+        /*! @param id The category id
+         *
+         *  @return The color
+         */
+        const bcr::CategoryColor &color( size_t id ) const
+        {
+            return this->colors[id];
+        }
+
+        //! Gets the escape sequence of a category
+        /*! This method gets the escape sequence that opens a text colored as the given category.
+         *
+         *  @param id The category id
+         *  @param is_bold Whether the text is bold
+         *
+         *  @return The escape sequence
+         */
+        const string &prefix( size_t id, bool is_bold = false ) const
+        {
+            return is_bold ? this->bold[id] : this->regular[id];
+        }
+
+        //! Colors a text
+        /*! This function colors a text as the given category, like `Color::tcolor()`.
+         *
+         *  @param msg The text
+         *  @param id The category id
+         *  @param is_bold Whether the text is bold
+         *
+         *  @return The colored text
+         */
+        string paint( const string &msg, size_t id, bool is_bold = false ) const
+        {
+            return prefix( id, is_bold ) + msg + Color::RESET;
+        }
+};
+
+#endif
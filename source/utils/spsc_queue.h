@@ -0,0 +1,169 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+/*!
+ *  This file contains a lock-free ring buffer connecting exactly one producer thread to exactly one consumer thread.
+ *  A side that has to wait spins for a little while, and then sleeps until the other side makes progress;
+ *  the lock is only ever taken by a side that is about to sleep, or to wake one.
+ *
+ *  @author Lucas Bazante
+ *  @file spsc_queue.h
+ */
+
+#include "common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+template < typename T >
+class SpscQueue
+{
+    private:
+        static constexpr size_t LINE{ 64 }; // cache line size, so the two indices don't share a line
+        static constexpr unsigned int SPINS{ 64 }; // tries before a waiting side goes to sleep
+
+        std::vector< T > slots; // the ring; one slot is always left empty to tell "full" from "empty"
+
+        alignas( LINE ) std::atomic< size_t > head{ 0 }; // next slot to be popped, written only by the consumer
+        alignas( LINE ) std::atomic< size_t > tail{ 0 }; // next slot to be pushed, written only by the producer
+
+        std::mutex lock; // guards the sleep
+        std::condition_variable parked; // where a waiting side sleeps
+        std::atomic< unsigned int > sleepers{ 0 }; // how many sides are asleep, or about to be
+
+        // the slot after `i`
+        size_t advance( size_t i ) const
+        {
+            return ( i + 1 == this->slots.size() ) ? 0 : i + 1;
+        }
+
+        // pushes an item, if there's room, without waking the consumer
+        bool put( const T &item )
+        {
+            size_t t = this->tail.load( std::memory_order_relaxed );
+            size_t next = advance( t );
+
+            if ( next == this->head.load( std::memory_order_acquire ) )
+                return false;
+
+            this->slots[t] = item;
+            this->tail.store( next, std::memory_order_release ); // publishes the item
+            return true;
+        }
+
+        // pops an item, if there's any, without waking the producer
+        bool take( T &item )
+        {
+            size_t h = this->head.load( std::memory_order_relaxed );
+
+            if ( h == this->tail.load( std::memory_order_acquire ) )
+                return false;
+
+            item = std::move( this->slots[h] );
+            this->head.store( advance( h ), std::memory_order_release ); // frees the slot
+            return true;
+        }
+
+        // wakes the other side, if it's asleep
+        void wake( void )
+        {
+            // pairs with the fence in `wait()`: either we see the sleeper, or it sees what we just did
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            if ( this->sleepers.load( std::memory_order_relaxed ) == 0 )
+                return;
+
+            { std::lock_guard< std::mutex > guard( this->lock ); } // so the wake can't fall between its check and its sleep
+            this->parked.notify_all();
+        }
+
+        // retries `done` until it succeeds, spinning first and then sleeping
+        template < typename Done >
+        void wait( Done done )
+        {
+            for ( unsigned int i = 0; i < SPINS; i++ )
+            {
+                if ( done() )
+                    return;
+                std::this_thread::yield();
+            }
+
+            this->sleepers.fetch_add( 1 );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            {
+                std::unique_lock< std::mutex > guard( this->lock );
+                this->parked.wait( guard, done );
+            }
+            this->sleepers.fetch_sub( 1 );
+        }
+
+    public:
+        //! Constructor
+        /*! Constructor method.
+         *  Sets how many items the queue can hold before the producer has to wait.
+         *
+         *  @param depth The capacity of the queue, at least 1
+         */
+        SpscQueue( size_t depth ) : slots( std::max< size_t >( depth, 1 ) + 1 )
+        { /* empty */ }
+
+        //! Tries to push an item
+        /*! This method pushes an item to the queue, if there is room for it.
+         *  Must only be called by the producer thread.
+         *
+         *  @param item The item to be pushed
+         *
+         *  @return True if pushed, false if the queue is full
+         */
+        bool try_push( const T &item )
+        {
+            if ( not put( item ) )
+                return false;
+
+            wake();
+            return true;
+        }
+
+        //! Tries to pop an item
+        /*! This method pops the oldest item from the queue, if there's any.
+         *  Must only be called by the consumer thread.
+         *
+         *  @param item Where the popped item is stored
+         *
+         *  @return True if popped, false if the queue is empty
+         */
+        bool try_pop( T &item )
+        {
+            if ( not take( item ) )
+                return false;
+
+            wake();
+            return true;
+        }
+
+        //! Pushes an item
+        /*! This method pushes an item to the queue, waiting while it's full.
+         *  Must only be called by the producer thread.
+         *
+         *  @param item The item to be pushed
+         */
+        void push( const T &item )
+        {
+            wait( [&]( void ) { return put( item ); } );
+            wake();
+        }
+
+        //! Pops an item
+        /*! This method pops the oldest item from the queue, waiting while it's empty.
+         *  Must only be called by the consumer thread.
+         *
+         *  @param item Where the popped item is stored
+         */
+        void pop( T &item )
+        {
+            wait( [&]( void ) { return take( item ); } );
+            wake();
+        }
+};
+
+#endif
@@ -67,6 +67,8 @@ namespace Color {
     }
 
     static string UNIT = "█"; // unit for the bar
+    static const string FULL_BAR = multiply( UNIT, 150 ); // the widest bar; any narrower one is a prefix of it
+    static const string RESET = "\e[0m"; // ends a colored text
 }
 
 #endif
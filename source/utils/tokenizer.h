@@ -0,0 +1,331 @@
+#ifndef _TOKENIZER_H_
+#define _TOKENIZER_H_
+
+/*!
+ *  Set of functions to split the data section of a file into lines and fields, and to convert
+ *  the numeric fields, as fast as the running CPU allows.
+ *
+ *  The input is scanned in blocks of 64 bytes; each block becomes a 64-bit mask, with one bit set
+ *  for each '\n' or ',' found, and the masks are flattened into a table of offsets. The block scan
+ *  uses AVX2 or SSE2 when available, picked once at runtime, and falls back to a plain loop otherwise.
+ *
+ *  @author Lucas Bazante
+ *  @file tokenizer.h
+ */
+
+#include "common.h"
+#include "cpu.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace Tokenizer {
+
+    // Alias
+    typedef uint64_t (*mask_fn)( const char *block );
+
+    static constexpr size_t BLOCK{ 64 }; // bytes scanned at once
+
+    //! Scans a block, scalar version
+    /*! This function scans a block of 64 bytes, setting the i-th bit of the mask if the i-th byte
+     *  is either a line break or a comma.
+     *
+     *  @param block Pointer to the first of the 64 bytes
+     *
+     *  @return The mask of delimiters found
+     */
+    inline uint64_t mask_scalar( const char *block )
+    {
+        uint64_t mask = 0;
+        for ( size_t i = 0; i < BLOCK; i++ )
+            if ( block[i] == '\n' or block[i] == ',' )
+                mask |= uint64_t( 1 ) << i;
+        return mask;
+    }
+
+#ifdef BCR_X86_SIMD
+    //! Scans a block, SSE2 version
+    /*! Same as `mask_scalar()`, comparing 16 bytes per instruction.
+     */
+    __attribute__(( target( "sse2" ) ))
+    inline uint64_t mask_sse2( const char *block )
+    {
+        const __m128i nl = _mm_set1_epi8( '\n' );
+        const __m128i comma = _mm_set1_epi8( ',' );
+        uint64_t mask = 0;
+
+        for ( size_t i = 0; i < BLOCK; i += 16 )
+        {
+            __m128i chunk = _mm_loadu_si128( reinterpret_cast< const __m128i* >( block + i ) );
+            __m128i hits = _mm_or_si128( _mm_cmpeq_epi8( chunk, nl ), _mm_cmpeq_epi8( chunk, comma ) );
+            mask |= uint64_t( uint16_t( _mm_movemask_epi8( hits ) ) ) << i;
+        }
+
+        return mask;
+    }
+
+    //! Scans a block, AVX2 version
+    /*! Same as `mask_scalar()`, comparing 32 bytes per instruction.
+     */
+    __attribute__(( target( "avx2" ) ))
+    inline uint64_t mask_avx2( const char *block )
+    {
+        const __m256i nl = _mm256_set1_epi8( '\n' );
+        const __m256i comma = _mm256_set1_epi8( ',' );
+
+        __m256i lo = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( block ) );
+        __m256i hi = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( block + 32 ) );
+
+        uint32_t mlo = _mm256_movemask_epi8( _mm256_or_si256( _mm256_cmpeq_epi8( lo, nl ), _mm256_cmpeq_epi8( lo, comma ) ) );
+        uint32_t mhi = _mm256_movemask_epi8( _mm256_or_si256( _mm256_cmpeq_epi8( hi, nl ), _mm256_cmpeq_epi8( hi, comma ) ) );
+
+        return uint64_t( mlo ) | ( uint64_t( mhi ) << 32 );
+    }
+#endif
+
+    //! Picks the block scanner
+    /*! This function picks the fastest block scanner supported by the running CPU.
+     *  The CPU is only checked once, by `Cpu::level()`.
+     *
+     *  @return Pointer to the chosen scanner
+     */
+    inline mask_fn block_scanner( void )
+    {
+#ifdef BCR_X86_SIMD
+        switch ( Cpu::level() )
+        {
+            case Cpu::AVX2: return mask_avx2;
+            case Cpu::SSE2: return mask_sse2;
+            default: break;
+        }
+#endif
+        return mask_scalar;
+    }
+
+    //! Class to walk over the delimiters of a buffer
+    /*! Each call to `next()` returns the offset of the next '\n' or ',' in the buffer.
+     *  Offsets are produced a whole block at a time into a small table, so the per-delimiter
+     *  work is only a table read.
+     */
+    class Scanner
+    {
+        private:
+            const char *data; // the buffer
+            size_t size; // its size
+            size_t base{ 0 }; // offset of the next block to be scanned
+            mask_fn scan; // the block scanner in use
+
+            array< size_t, BLOCK > table; // offsets found on the last scanned block
+            size_t count{ 0 }; // how many offsets are in the table
+            size_t at{ 0 }; // the next offset to be returned
+
+            // scans blocks until at least one delimiter is found, or the buffer ends
+            void refill( void )
+            {
+                count = at = 0;
+
+                while ( count == 0 and base < size )
+                {
+                    uint64_t mask;
+
+                    if ( size - base >= BLOCK )
+                        mask = scan( data + base );
+                    else // the tail is padded, so we never read past the buffer
+                    {
+                        char tail[BLOCK] = {};
+                        std::memcpy( tail, data + base, size - base );
+                        mask = mask_scalar( tail ) & ( ( uint64_t( 1 ) << ( size - base ) ) - 1 );
+                    }
+
+                    while ( mask )
+                    {
+                        table[count++] = base + __builtin_ctzll( mask );
+                        mask &= mask - 1; // clears lowest set bit
+                    }
+
+                    base += BLOCK;
+                }
+            }
+
+        public:
+            //! Constructor
+            /*! Constructor method.
+             *
+             *  @param d Pointer to the buffer
+             *  @param n Size of the buffer
+             */
+            Scanner( const char *d, size_t n ) : data{ d }, size{ n }, scan{ block_scanner() }
+            { /* empty */ }
+
+            //! Gets the next delimiter
+            /*! This method returns the offset of the next delimiter.
+             *
+             *  @return The offset, or the buffer size if there are no more delimiters.
+             */
+            size_t next( void )
+            {
+                if ( at == count )
+                {
+                    refill();
+                    if ( count == 0 )
+                        return size;
+                }
+
+                return table[at++];
+            }
+    };
+
+#ifdef BCR_LITTLE_ENDIAN
+    //! Converts eight digits at once
+    /*! This function checks if the 8 bytes pointed by `p` are all digits and, if so,
+     *  converts them with a handful of integer multiplications, without a loop.
+     *  The first digit must land on the lowest byte of the word, so it's only built on little-endian targets.
+     *
+     *  @param p Pointer to the 8 bytes
+     *  @param out Where the converted value is stored
+     *
+     *  @return True if all 8 bytes are digits, false otherwise
+     */
+    inline bool parse_eight( const char *p, uint64_t &out )
+    {
+        uint64_t v;
+        std::memcpy( &v, p, sizeof( v ) );
+
+        // every byte must be in [0x30, 0x39]
+        if ( ( ( v & 0xF0F0F0F0F0F0F0F0 ) | ( ( ( v + 0x0606060606060606 ) & 0xF0F0F0F0F0F0F0F0 ) >> 4 ) ) != 0x3333333333333333 )
+            return false;
+
+        v -= 0x3030303030303030;
+        v = ( v * 10 ) + ( v >> 8 ); // pairs of digits
+        v = ( ( ( v & 0x000000FF000000FF ) * ( 100 + ( 1000000ULL << 32 ) ) )
+            + ( ( ( v >> 16 ) & 0x000000FF000000FF ) * ( 1 + ( 10000ULL << 32 ) ) ) ) >> 32;
+
+        out = v;
+        return true;
+    }
+#endif
+
+    //! Converts a text field to an integer
+    /*! This function converts the text in [first, last) to an integer, with an optional sign.
+     *  Conversion stops at the first non-digit, like `std::stoi`, but it fails, instead of throwing,
+     *  when there are no digits or the value doesn't fit the integer type.
+     *
+     *  @param first Pointer to the first character
+     *  @param last Pointer past the last character
+     *  @param out Where the converted value is stored
+     *
+     *  @return True if the conversion went fine, false otherwise
+     */
+    template < typename Int >
+    bool parse_integer( const char *first, const char *last, Int &out )
+    {
+        while ( first != last and ( *first == ' ' or *first == '\t' ) )
+            first++;
+
+        bool negative = false;
+        if ( first != last and ( *first == '-' or *first == '+' ) )
+            negative = ( *first++ == '-' );
+
+        const char *start = first;
+        uint64_t acc = 0;
+
+#ifdef BCR_LITTLE_ENDIAN
+        while ( last - first >= 8 )
+        {
+            uint64_t chunk;
+            if ( not parse_eight( first, chunk ) )
+                break;
+            if ( __builtin_mul_overflow( acc, uint64_t( 100000000 ), &acc ) or __builtin_add_overflow( acc, chunk, &acc ) )
+                return false;
+            first += 8;
+        }
+#endif
+
+        while ( first != last and *first >= '0' and *first <= '9' )
+        {
+            if ( __builtin_mul_overflow( acc, uint64_t( 10 ), &acc ) or __builtin_add_overflow( acc, uint64_t( *first - '0' ), &acc ) )
+                return false;
+            first++;
+        }
+
+        if ( first == start ) // no digits at all
+            return false;
+
+        uint64_t limit = negative ? uint64_t( std::numeric_limits< Int >::max() ) + 1 : uint64_t( std::numeric_limits< Int >::max() );
+        if ( acc > limit )
+            return false;
+
+        out = negative ? Int( 0 - acc ) : Int( acc );
+        return true;
+    }
+
+    //! Converts a text field to a floating-point number
+    /*! This function converts the text in [first, last) to a double, skipping leading blanks and an optional '+'.
+     *  Conversion stops at the first character that can't be part of the number.
+     *  "nan" and "inf" are refused, as bars can't be ordered nor scaled by them.
+     *
+     *  @param first Pointer to the first character
+     *  @param last Pointer past the last character
+     *  @param out Where the converted value is stored
+     *
+     *  @return True if the conversion went fine, false otherwise
+     */
+    inline bool parse_real( const char *first, const char *last, double &out )
+    {
+        while ( first != last and ( *first == ' ' or *first == '\t' ) )
+            first++;
+
+        if ( first != last and *first == '+' )
+            first++;
+
+        auto result = std::from_chars( first, last, out );
+        return result.ec == std::errc() and std::isfinite( out );
+    }
+
+    //! Converts a text field to a value
+    /*! This function converts the text in [first, last) with the parser matching the value type.
+     *
+     *  @param first Pointer to the first character
+     *  @param last Pointer past the last character
+     *  @param out Where the converted value is stored
+     *
+     *  @return True if the conversion went fine, false otherwise
+     */
+    template < typename Value >
+    bool parse_value( const char *first, const char *last, Value &out )
+    {
+        if constexpr ( std::is_floating_point< Value >::value )
+            return parse_real( first, last, out );
+        else
+            return parse_integer( first, last, out );
+    }
+
+    // a field inside the buffer, [first, last)
+    struct Field
+    {
+        const char *first;
+        const char *last;
+    };
+
+    //! Converts a column of fields
+    /*! This function converts a batch of text fields to values in one go, so the conversion loop runs hot
+     *  over the whole column instead of being interleaved with the tokenizing.
+     *
+     *  @param fields The fields to be converted
+     *  @param out Pointer to where the n converted values are stored
+     *
+     *  @return True if every field was converted, false otherwise
+     */
+    template < typename Value >
+    bool parse_column( const std::vector< Field > &fields, Value *out )
+    {
+        for ( size_t i = 0; i < fields.size(); i++ )
+            if ( not parse_value( fields[i].first, fields[i].last, out[i] ) )
+                return false;
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef _WIDTHS_H_
+#define _WIDTHS_H_
+
+/*!
+ *  Set of functions to turn bar values into bar widths, relative to the greatest value of their chart.
+ *  A whole column of values is scaled at once; the column is processed 4 doubles at a time with AVX2 or
+ *  2 at a time with SSE2 when available, picked once at runtime, and one at a time otherwise.
+ *  Every version gives exactly the same widths.
+ *
+ *  @author Lucas Bazante
+ *  @file widths.h
+ */
+
+#include "common.h"
+#include "cpu.h"
+
+#include <cstring>
+
+namespace Widths {
+
+    // Alias
+    typedef void (*scale_fn)( const double *values, const double *maxes, size_t n, unsigned char *out );
+
+    static constexpr double FULL{ 150 }; // the full width
+
+    //! Width of a value
+    /*! This function gets the width, from 0 up to the full 150, of a value relative to the max value.
+     *  Non-positive values, or a non-positive max, get no width at all; values too big to be told apart from the max get the full width.
+     *
+     *  @param value The value
+     *  @param max The max value
+     *
+     *  @return The width
+     */
+    inline unsigned char width( double value, double max )
+    {
+        if ( not ( max > 0 and value > 0 ) )
+            return 0;
+
+        double w = FULL * ( value / max );
+        return ( w < FULL ) ? ( unsigned char ) w : FULL;
+    }
+
+    //! Scales a column, scalar version
+    /*! This function sets out[i] to the width of values[i] relative to maxes[i], for i in [0, n).
+     *
+     *  @param values The values
+     *  @param maxes The max value of the chart of each value
+     *  @param n How many values
+     *  @param out Where the widths are stored
+     */
+    inline void scale_scalar( const double *values, const double *maxes, size_t n, unsigned char *out )
+    {
+        for ( size_t i = 0; i < n; i++ )
+            out[i] = width( values[i], maxes[i] );
+    }
+
+#ifdef BCR_X86_SIMD
+    //! Scales a column, SSE2 version
+    /*! Same as `scale_scalar()`, 2 values at a time.
+     */
+    __attribute__(( target( "sse2" ) ))
+    inline void scale_sse2( const double *values, const double *maxes, size_t n, unsigned char *out )
+    {
+        const __m128d zero = _mm_setzero_pd();
+        const __m128d full = _mm_set1_pd( FULL );
+        size_t i = 0;
+
+        for ( ; i + 2 <= n; i += 2 )
+        {
+            __m128d v = _mm_loadu_pd( values + i );
+            __m128d m = _mm_loadu_pd( maxes + i );
+            __m128d w = _mm_mul_pd( full, _mm_div_pd( v, m ) );
+
+            __m128d keep = _mm_and_pd( _mm_cmpgt_pd( v, zero ), _mm_cmpgt_pd( m, zero ) ); // the others get 0
+            w = _mm_and_pd( _mm_min_pd( w, full ), keep );
+
+            __m128i t = _mm_cvttpd_epi32( w );
+            out[i] = ( unsigned char ) _mm_cvtsi128_si32( t );
+            out[i + 1] = ( unsigned char ) _mm_cvtsi128_si32( _mm_srli_si128( t, 4 ) );
+        }
+
+        scale_scalar( values + i, maxes + i, n - i, out + i );
+    }
+
+    //! Scales a column, AVX2 version
+    /*! Same as `scale_scalar()`, 4 values at a time.
+     */
+    __attribute__(( target( "avx2" ) ))
+    inline void scale_avx2( const double *values, const double *maxes, size_t n, unsigned char *out )
+    {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d full = _mm256_set1_pd( FULL );
+        size_t i = 0;
+
+        for ( ; i + 4 <= n; i += 4 )
+        {
+            __m256d v = _mm256_loadu_pd( values + i );
+            __m256d m = _mm256_loadu_pd( maxes + i );
+            __m256d w = _mm256_mul_pd( full, _mm256_div_pd( v, m ) );
+
+            __m256d keep = _mm256_and_pd( _mm256_cmp_pd( v, zero, _CMP_GT_OQ ), _mm256_cmp_pd( m, zero, _CMP_GT_OQ ) ); // the others get 0
+            w = _mm256_and_pd( _mm256_min_pd( w, full ), keep );
+
+            __m128i t = _mm256_cvttpd_epi32( w );
+            t = _mm_packus_epi32( t, t ); // 32 -> 16 bits
+            t = _mm_packus_epi16( t, t ); // 16 -> 8 bits
+            int packed = _mm_cvtsi128_si32( t );
+            std::memcpy( out + i, &packed, 4 );
+        }
+
+        scale_scalar( values + i, maxes + i, n - i, out + i );
+    }
+#endif
+
+    //! Picks the column scaler
+    /*! This function picks the fastest column scaler supported by the running CPU.
+     *  The CPU is only checked once, by `Cpu::level()`.
+     *
+     *  @return Pointer to the chosen scaler
+     */
+    inline scale_fn column_scaler( void )
+    {
+#ifdef BCR_X86_SIMD
+        switch ( Cpu::level() )
+        {
+            case Cpu::AVX2: return scale_avx2;
+            case Cpu::SSE2: return scale_sse2;
+            default: break;
+        }
+#endif
+        return scale_scalar;
+    }
+
+    //! Scales a column
+    /*! This function sets out[i] to the width of values[i] relative to maxes[i], for i in [0, n),
+     *  with the fastest scaler available.
+     *
+     *  @param values The values
+     *  @param maxes The max value of the chart of each value
+     *  @param n How many values
+     *  @param out Where the widths are stored
+     */
+    inline void scale( const double *values, const double *maxes, size_t n, unsigned char *out )
+    {
+        column_scaler()( values, maxes, n, out );
+    }
+}
+
+#endif